@@ -0,0 +1,174 @@
+//
+//  ECElevatorBank.cpp
+//
+//
+//  Bank of elevators sharing the hall calls of one building
+
+#include "ECElevatorBank.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+using namespace std;
+
+template<class TPolicy>
+ECElevatorBankT<TPolicy>::ECElevatorBankT(int numFloors, int numCars, std::vector<ECElevatorSimRequest> &listRequests)
+    : numFloors(numFloors), storeOwned(listRequests), store(storeOwned), arrivalCursor(0),
+      listAssignedCar(listRequests.size(), -1), listHallCallCarUp(numFloors + 1, -1), listHallCallCarDown(numFloors + 1, -1)
+{
+    Init(numCars, &listRequests);
+}
+
+template<class TPolicy>
+ECElevatorBankT<TPolicy>::ECElevatorBankT(int numFloors, int numCars, ECElevatorRequestStore &store)
+    : numFloors(numFloors), store(store), arrivalCursor(0),
+      listAssignedCar(store.GetSize(), -1), listHallCallCarUp(numFloors + 1, -1), listHallCallCarDown(numFloors + 1, -1)
+{
+    Init(numCars, nullptr);
+}
+
+template<class TPolicy>
+void ECElevatorBankT<TPolicy>::Init(int numCars, std::vector<ECElevatorSimRequest> *pListRequests)
+{
+    for (int i = 0; i < numCars; ++i)
+    {
+        listCars.emplace_back(new ECCar(numFloors, store, false, pListRequests));
+    }
+
+    arrivalOrder.resize(store.GetSize());
+    for (size_t i = 0; i < arrivalOrder.size(); ++i)
+    {
+        arrivalOrder[i] = (int)i;
+    }
+    if (!store.IsSortedByTime())
+    {
+        const ECElevatorRequestStore &storeSort = store;
+        stable_sort(arrivalOrder.begin(), arrivalOrder.end(), [&storeSort](int a, int b) {
+            return storeSort.GetTime(a) < storeSort.GetTime(b);
+        });
+    }
+}
+
+template<class TPolicy>
+void ECElevatorBankT<TPolicy>::SetTimeSkipping(bool f)
+{
+    for (auto &car : listCars)
+    {
+        car->SetTimeSkipping(f);
+    }
+}
+
+template<class TPolicy>
+void ECElevatorBankT<TPolicy>::Simulate(int lenSim)
+{
+    // requests made after lenSim + 1 can't be picked up by any car in this run
+    while (arrivalCursor < arrivalOrder.size() && store.GetTime(arrivalOrder[arrivalCursor]) <= lenSim + 1)
+    {
+        // bring every car up to just before it could see requests made at timeReq
+        int timeReq = store.GetTime(arrivalOrder[arrivalCursor]);
+        for (auto &car : listCars)
+        {
+            car->Simulate(timeReq - 2);
+        }
+
+        while (arrivalCursor < arrivalOrder.size() && store.GetTime(arrivalOrder[arrivalCursor]) == timeReq)
+        {
+            int req = arrivalOrder[arrivalCursor++];
+            int floorSrc = store.GetFloorSrc(req);
+            // requests no car can service stay with no car (-1)
+            if (!IsValidRequest(floorSrc, store.GetFloorDest(req)))
+            {
+                continue;
+            }
+            bool fGoingUp = store.IsGoingUp(req);
+            int car = ChooseCar(floorSrc, fGoingUp);
+            listAssignedCar[req] = car;
+            listCars[car]->AssignRequest(req);
+            (fGoingUp ? listHallCallCarUp : listHallCallCarDown)[floorSrc] = car;
+        }
+    }
+
+    for (auto &car : listCars)
+    {
+        car->Simulate(lenSim);
+    }
+}
+
+template<class TPolicy>
+ECElevatorSimStats ECElevatorBankT<TPolicy>::GetStats() const
+{
+    ECElevatorSimStats stats;
+    for (auto &car : listCars)
+    {
+        stats.Merge(car->GetStats());
+    }
+    return stats;
+}
+
+template<class TPolicy>
+bool ECElevatorBankT<TPolicy>::IsValidRequest(int floorSrc, int floorDest) const
+{
+    return floorSrc != floorDest && floorSrc >= 1 && floorSrc <= numFloors && floorDest >= 1 && floorDest <= numFloors;
+}
+
+template<class TPolicy>
+int ECElevatorBankT<TPolicy>::ChooseCar(int floorSrc, bool fGoingUp) const
+{
+    // some car is already stopping here to pick up passengers going the same way
+    int carHallCall = (fGoingUp ? listHallCallCarUp : listHallCallCarDown)[floorSrc];
+    if (carHallCall >= 0 &&
+        (fGoingUp ? listCars[carHallCall]->HasHallCallUpAt(floorSrc) : listCars[carHallCall]->HasHallCallDownAt(floorSrc)))
+    {
+        return carHallCall;
+    }
+
+    int carBest = 0;
+    int costBest = INT_MAX;
+    for (int i = 0; i < (int)listCars.size(); ++i)
+    {
+        int cost = EstimateCost(i, floorSrc, fGoingUp);
+        if (cost < costBest)
+        {
+            carBest = i;
+            costBest = cost;
+        }
+    }
+    return carBest;
+}
+
+// Floors car i travels before picking up a passenger at floorSrc going up (down),
+// plus one per request it has and not yet serviced: passengers waiting for it or
+// riding in it, and requests it has not collected yet. A car moving away from
+// floorSrc finishes its sweep first; so does one coming towards it the other way
+// than the passenger goes, if passengers only get in going their way (directional
+// policies): it picks the passenger up on the way back
+template<class TPolicy>
+int ECElevatorBankT<TPolicy>::EstimateCost(int i, int floorSrc, bool fGoingUp) const
+{
+    const ECCar &car = *listCars[i];
+    int floorCar = car.GetCurrFloor();
+    EC_ELEVATOR_DIR dirCar = car.GetCurrDir();
+    bool fAhead = (dirCar == EC_ELEVATOR_UP && floorSrc >= floorCar) || (dirCar == EC_ELEVATOR_DOWN && floorSrc <= floorCar);
+    bool fSameWay = (dirCar == EC_ELEVATOR_UP) == fGoingUp;
+    int cost;
+    if (dirCar == EC_ELEVATOR_STOPPED || (fAhead && (fSameWay || !TPolicy::fDirectional)))
+    {
+        cost = abs(floorSrc - floorCar);
+    }
+    else
+    {
+        int floorTurn = car.GetFarthestCallAhead();
+        if (fAhead)
+        {
+            floorTurn = dirCar == EC_ELEVATOR_UP ? max(floorTurn, floorSrc) : min(floorTurn, floorSrc);
+        }
+        cost = abs(floorTurn - floorCar) + abs(floorTurn - floorSrc);
+    }
+    return cost + car.GetNumPendingRequests() + car.GetNumPassengersInCabin() + car.GetNumRequestsToCome();
+}
+
+// Shipped policies
+template class ECElevatorBankT<ECNearestCallPolicy>;
+template class ECElevatorBankT<ECLookPolicy>;
+template class ECElevatorBankT<ECScanPolicy>;
+template class ECElevatorBankT<ECCollectivePolicy>;
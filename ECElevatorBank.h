@@ -0,0 +1,79 @@
+//
+//  ECElevatorBank.h
+//
+//
+//  Bank of elevators sharing the hall calls of one building
+
+#ifndef ECElevatorBank_h
+#define ECElevatorBank_h
+
+#include "ECElevatorSim.h"
+#include <memory>
+#include <vector>
+
+//*****************************************************************************
+// A bank of numCars elevators (each an ECElevatorSimT) serving one list of requests.
+// When a request is made, the dispatcher hands it to one car:
+// (i) if a car is already going to pick up passengers at that floor going the same
+// way (shared hall-call table, by floor and direction), the request goes to that car
+// (ii) otherwise to the car with the lowest estimated cost: floors to travel before
+// picking the passenger up (a car moving away finishes its sweep and comes back),
+// plus the requests the car has and not yet serviced
+// Requests no car can service (floors outside the building, or the same floor) go
+// to no car
+//
+// The dispatcher decides from the cars' state two time units before the request is
+// made (a car may handle the next floor and stop in one step). With one car every
+// request goes to that car and the results are the same as ECElevatorSimT<TPolicy>.
+// Cars use scheduling policy TPolicy; the shipped policies are instantiated in
+// ECElevatorBank.cpp
+
+template<class TPolicy = ECNearestCallPolicy>
+class ECElevatorBankT
+{
+public:
+    typedef ECElevatorSimT<TPolicy> ECCar;
+
+    // Progress of each request is written back to listRequests
+    ECElevatorBankT(int numFloors, int numCars, std::vector<ECElevatorSimRequest> &listRequests);
+    // Cars share store (nothing is copied)
+    ECElevatorBankT(int numFloors, int numCars, ECElevatorRequestStore &store);
+    // the cars refer to store: a copy would share them
+    ECElevatorBankT(const ECElevatorBankT &) = delete;
+    ECElevatorBankT &operator=(const ECElevatorBankT &) = delete;
+
+    void Simulate(int lenSim);
+    void SetTimeSkipping(bool f);
+
+    int GetNumCars() const { return (int)listCars.size(); }
+    const ECCar &GetCar(int i) const { return *listCars[i]; }
+    // Which car got request req (-1: not dispatched yet, or never: it can't be serviced)
+    int GetAssignedCar(int req) const { return listAssignedCar[req]; }
+
+    // Wait, ride and trip times over all cars
+    ECElevatorSimStats GetStats() const;
+
+private:
+    void Init(int numCars, std::vector<ECElevatorSimRequest> *pListRequests);
+    bool IsValidRequest(int floorSrc, int floorDest) const;
+    int ChooseCar(int floorSrc, bool fGoingUp) const;
+    int EstimateCost(int i, int floorSrc, bool fGoingUp) const;
+
+    int numFloors;
+    ECElevatorRequestStore storeOwned;
+    ECElevatorRequestStore &store;
+    std::vector<std::unique_ptr<ECCar>> listCars;
+
+    // requests by time, and how far dispatching has got
+    std::vector<int> arrivalOrder;
+    size_t arrivalCursor;
+    std::vector<int> listAssignedCar;
+
+    // shared hall-call table: the car picking up at each floor, by direction (-1 if none)
+    std::vector<int> listHallCallCarUp;
+    std::vector<int> listHallCallCarDown;
+};
+
+typedef ECElevatorBankT<ECNearestCallPolicy> ECElevatorBank;
+
+#endif /* ECElevatorBank_h */
@@ -0,0 +1,249 @@
+//
+//  ECElevatorBenchmark.cpp
+//
+//
+//  Timing the simulation engine on synthetic workloads
+
+#include "ECElevatorBenchmark.h"
+#include "ECElevatorWorkload.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+static const char *listTrafficNames[EC_NUM_TRAFFICS] = {"uniform", "uppeak", "downpeak", "interfloor"};
+
+const char *ECGetTrafficName(EC_TRAFFIC traffic)
+{
+    return listTrafficNames[traffic];
+}
+
+bool ECParseTraffic(const std::string &name, EC_TRAFFIC &traffic)
+{
+    for (int i = 0; i < EC_NUM_TRAFFICS; ++i)
+    {
+        if (name == listTrafficNames[i])
+        {
+            traffic = (EC_TRAFFIC)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ECMakeBenchmarkWorkload(EC_TRAFFIC traffic, int numFloors, int numRequests, uint64_t seed, ECElevatorRequestStore &store)
+{
+    // a request goes from one floor to another
+    assert(numFloors >= 2);
+    ECRandom rng(seed);
+    // interfloor traffic needs two floors above the lobby
+    int floorLow = (traffic == EC_TRAFFIC_INTERFLOOR && numFloors >= 3) ? 2 : 1;
+    auto randomFloor = [&rng, numFloors](int floorFrom) { return floorFrom + rng.NextInt(numFloors - floorFrom + 1); };
+
+    store.Reserve(store.GetSize() + numRequests);
+    double time = 0.0;
+    for (int i = 0; i < numRequests; ++i)
+    {
+        time += rng.NextExponential(0.5);
+        int floorSrc, floorDest;
+        bool fPeak = rng.NextDouble() < 0.9;
+        if (traffic == EC_TRAFFIC_UP_PEAK && fPeak)
+        {
+            floorSrc = 1;
+            floorDest = randomFloor(2);
+        }
+        else if (traffic == EC_TRAFFIC_DOWN_PEAK && fPeak)
+        {
+            floorSrc = randomFloor(2);
+            floorDest = 1;
+        }
+        else
+        {
+            floorSrc = randomFloor(floorLow);
+            // any other floor
+            floorDest = floorLow + rng.NextInt(numFloors - floorLow);
+            if (floorDest >= floorSrc)
+            {
+                ++floorDest;
+            }
+        }
+        store.Add((int)time, floorSrc, floorDest);
+    }
+}
+
+std::string ECBenchmarkCase::GetKey() const
+{
+    ostringstream oss;
+    oss << ECGetTrafficName(traffic) << ',' << numFloors << ',' << numRequests << ',' << (fTimeSkipping ? "skip" : "tick");
+    return oss.str();
+}
+
+static long long GetPeakRSSKB()
+{
+#if defined(__APPLE__)
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss / 1024 : 0;   // bytes on macOS
+#elif defined(__unix__)
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+#else
+    return 0;
+#endif
+}
+
+ECBenchmarkResult ECRunBenchmarkCase(const ECBenchmarkCase &bcase, uint64_t seed)
+{
+    // same workload for a case whatever else runs (FNV-1a of the case without the mode)
+    ostringstream oss;
+    oss << ECGetTrafficName(bcase.traffic) << ',' << bcase.numFloors << ',' << bcase.numRequests;
+    string keyWorkload = oss.str();
+    uint64_t hash = 14695981039346656037ULL ^ seed;
+    for (char c : keyWorkload)
+    {
+        hash = (hash ^ (unsigned char)c) * 1099511628211ULL;
+    }
+
+    ECElevatorRequestStore store;
+    ECMakeBenchmarkWorkload(bcase.traffic, bcase.numFloors, bcase.numRequests, hash, store);
+
+    auto timeStart = chrono::steady_clock::now();
+    ECElevatorSim sim(bcase.numFloors, store);
+    sim.SetTimeSkipping(bcase.fTimeSkipping);
+    while (!sim.IsFinished())
+    {
+        sim.RunUntil(sim.GetTimeElapsed() + 4096);
+    }
+    chrono::duration<double> timeWall = chrono::steady_clock::now() - timeStart;
+
+    // simulated time: up to the last arrival (the rest of the last chunk is idle)
+    int timeLast = 0;
+    for (size_t i = 0; i < store.GetSize(); ++i)
+    {
+        timeLast = max(timeLast, store.GetArriveTime((int)i));
+    }
+
+    ECBenchmarkResult result;
+    result.bcase = bcase;
+    result.numTicks = timeLast + 1;
+    result.numServiced = sim.GetStats().GetNumServiced();
+    result.timeWall = timeWall.count();
+    result.nsPerTick = result.numTicks > 0 ? result.timeWall * 1e9 / result.numTicks : 0.0;
+    result.nsPerRequest = bcase.numRequests > 0 ? result.timeWall * 1e9 / bcase.numRequests : 0.0;
+    result.peakRSSKB = GetPeakRSSKB();
+    return result;
+}
+
+bool ECReadBenchmarkBaseline(std::istream &is, std::map<std::string, double> &baseline)
+{
+    string line;
+    while (getline(is, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        istringstream iss(line);
+        string key;
+        double nsPerRequest;
+        if (!(iss >> key >> nsPerRequest))
+        {
+            return false;
+        }
+        baseline[key] = nsPerRequest;
+    }
+    return true;
+}
+
+void ECWriteBenchmarkBaseline(std::ostream &os, const std::vector<ECBenchmarkResult> &listResults)
+{
+    os << "# ElevatorBenchmark baseline: case ns_per_request\n";
+    for (const auto &result : listResults)
+    {
+        os << result.bcase.GetKey() << ' ' << result.nsPerRequest << '\n';
+    }
+}
+
+void ECPrintBenchmarkHeader(std::ostream &os)
+{
+    os << "traffic     floors   requests mode        ticks   wall_s   ns/tick    ns/req  peak_MB\n";
+}
+
+void ECPrintBenchmarkResult(std::ostream &os, const ECBenchmarkResult &result)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%-10s %7d %10d %-4s %12lld %8.3f %9.2f %9.1f %8.1f\n", ECGetTrafficName(result.bcase.traffic),
+             result.bcase.numFloors, result.bcase.numRequests, result.bcase.fTimeSkipping ? "skip" : "tick",
+             result.numTicks, result.timeWall, result.nsPerTick, result.nsPerRequest, result.peakRSSKB / 1024.0);
+    os << line;
+}
+
+int ECPrintBenchmarkComparison(std::ostream &os, const std::vector<ECBenchmarkResult> &listResults,
+                               const std::map<std::string, double> &baseline, double thresholdPct)
+{
+    int numRegressions = 0;
+    os << "case                                baseline    ns/req   change\n";
+    for (const auto &result : listResults)
+    {
+        string key = result.bcase.GetKey();
+        auto it = baseline.find(key);
+        if (it == baseline.end() || it->second <= 0.0)
+        {
+            continue;
+        }
+        double changePct = (result.nsPerRequest / it->second - 1.0) * 100.0;
+        bool fRegression = changePct > thresholdPct;
+        numRegressions += fRegression;
+        char line[160];
+        snprintf(line, sizeof(line), "%-34s %9.1f %9.1f %+7.1f%%%s\n", key.c_str(), it->second, result.nsPerRequest, changePct,
+                 fRegression ? "  REGRESSION" : "");
+        os << line;
+    }
+    return numRegressions;
+}
+
+void ECPrintBenchmarkScaling(std::ostream &os, const std::vector<ECBenchmarkResult> &listResults)
+{
+    // series: same traffic, floors and mode (listed as first run), sizes in the order run
+    vector<string> listNames;
+    map<string, vector<const ECBenchmarkResult *>> mapSeries;
+    for (const auto &result : listResults)
+    {
+        ostringstream oss;
+        oss << ECGetTrafficName(result.bcase.traffic) << ' ' << result.bcase.numFloors << " floors "
+            << (result.bcase.fTimeSkipping ? "skip" : "tick");
+        if (mapSeries.find(oss.str()) == mapSeries.end())
+        {
+            listNames.push_back(oss.str());
+        }
+        mapSeries[oss.str()].push_back(&result);
+    }
+    for (const string &name : listNames)
+    {
+        const vector<const ECBenchmarkResult *> &series = mapSeries[name];
+        if (series.size() < 2)
+        {
+            continue;
+        }
+        os << name << ':';
+        for (size_t i = 1; i < series.size(); ++i)
+        {
+            const ECBenchmarkResult &prev = *series[i - 1], &curr = *series[i];
+            if (prev.timeWall <= 0.0 || curr.bcase.numRequests == prev.bcase.numRequests)
+            {
+                continue;
+            }
+            double exponent = log(curr.timeWall / prev.timeWall) / log((double)curr.bcase.numRequests / prev.bcase.numRequests);
+            char buf[64];
+            snprintf(buf, sizeof(buf), " %d->%d %.2f", prev.bcase.numRequests, curr.bcase.numRequests, exponent);
+            os << buf;
+        }
+        os << '\n';
+    }
+}
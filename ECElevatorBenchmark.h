@@ -0,0 +1,90 @@
+//
+//  ECElevatorBenchmark.h
+//
+//
+//  Timing the simulation engine on synthetic workloads
+
+#ifndef ECElevatorBenchmark_h
+#define ECElevatorBenchmark_h
+
+#include "ECElevatorSim.h"
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Traffic patterns of synthetic workloads:
+// (i) uniform: any floor to any other floor
+// (ii) up-peak (morning): 90% from the lobby (floor 1) up, the rest uniform
+// (iii) down-peak (evening): 90% down to the lobby, the rest uniform
+// (iv) interfloor: between floors above the lobby only
+
+typedef enum
+{
+    EC_TRAFFIC_UNIFORM = 0,
+    EC_TRAFFIC_UP_PEAK,
+    EC_TRAFFIC_DOWN_PEAK,
+    EC_TRAFFIC_INTERFLOOR,
+    EC_NUM_TRAFFICS
+} EC_TRAFFIC;
+
+const char *ECGetTrafficName(EC_TRAFFIC traffic);
+// false if name is not uniform, uppeak, downpeak or interfloor
+bool ECParseTraffic(const std::string &name, EC_TRAFFIC &traffic);
+
+// numRequests requests in time order (one every 2 time units on average, Poisson
+// arrivals) appended to store; the same seed always gives the same requests.
+// numFloors must be 2 or more
+void ECMakeBenchmarkWorkload(EC_TRAFFIC traffic, int numFloors, int numRequests, uint64_t seed, ECElevatorRequestStore &store);
+
+//*****************************************************************************
+// One timed run: a single elevator (nearest-call policy) over a synthetic workload,
+// simulated until every passenger has arrived
+
+struct ECBenchmarkCase
+{
+    EC_TRAFFIC traffic;
+    int numFloors;
+    int numRequests;
+    bool fTimeSkipping;
+
+    // "traffic,floors,requests,mode": names the case in baseline files
+    std::string GetKey() const;
+};
+
+struct ECBenchmarkResult
+{
+    ECBenchmarkCase bcase;
+    long long numTicks;         // simulated time units
+    long long numServiced;
+    double timeWall;            // seconds in Simulate, workload not included
+    double nsPerTick;
+    double nsPerRequest;
+    long long peakRSSKB;        // peak resident memory of the process so far (0 if unknown)
+};
+
+ECBenchmarkResult ECRunBenchmarkCase(const ECBenchmarkCase &bcase, uint64_t seed);
+
+//*****************************************************************************
+// Baseline files: one "key nsPerRequest" line per case (# starts a comment)
+
+bool ECReadBenchmarkBaseline(std::istream &is, std::map<std::string, double> &baseline);
+void ECWriteBenchmarkBaseline(std::ostream &os, const std::vector<ECBenchmarkResult> &listResults);
+
+// Table of results, one row per case
+void ECPrintBenchmarkHeader(std::ostream &os);
+void ECPrintBenchmarkResult(std::ostream &os, const ECBenchmarkResult &result);
+
+// Change in ns per request of each case found in baseline; cases slower by more
+// than thresholdPct percent are marked. Returns how many were
+int ECPrintBenchmarkComparison(std::ostream &os, const std::vector<ECBenchmarkResult> &listResults,
+                               const std::map<std::string, double> &baseline, double thresholdPct);
+
+// Scaling curves: for each traffic, floor count and mode, how the time grows with
+// the number of requests, as the exponent k of time ~ requests^k between
+// consecutive sizes (1: linear)
+void ECPrintBenchmarkScaling(std::ostream &os, const std::vector<ECBenchmarkResult> &listResults);
+
+#endif /* ECElevatorBenchmark_h */
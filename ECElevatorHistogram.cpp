@@ -0,0 +1,83 @@
+//
+//  ECElevatorHistogram.cpp
+//
+//
+//  Log-bucketed histograms of times (wait, ride, trip)
+
+#include "ECElevatorHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+void ECLatencyHistogram::Merge(const ECLatencyHistogram &other)
+{
+    if (other.listCounts.size() > listCounts.size())
+    {
+        listCounts.resize(other.listCounts.size(), 0);
+    }
+    for (size_t i = 0; i < other.listCounts.size(); ++i)
+    {
+        listCounts[i] += other.listCounts[i];
+    }
+    count += other.count;
+    total += other.total;
+    timeMax = max(timeMax, other.timeMax);
+}
+
+// Largest time that falls in bucket
+long long ECLatencyHistogram::GetBucketTop(size_t bucket)
+{
+    if (bucket < 64)
+    {
+        return (long long)bucket;
+    }
+    int exp = (int)(bucket / 32) + 4;
+    long long bottom = (long long)(bucket % 32 + 32) << (exp - EC_HIST_SUB_BITS);
+    return bottom + (1LL << (exp - EC_HIST_SUB_BITS)) - 1;
+}
+
+int ECLatencyHistogram::GetPercentile(double p) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    long long rank = max(1LL, (long long)ceil(p / 100.0 * count));
+    long long seen = 0;
+    for (size_t i = 0; i < listCounts.size(); ++i)
+    {
+        seen += listCounts[i];
+        if (seen >= rank)
+        {
+            return (int)min(GetBucketTop(i), (long long)timeMax);
+        }
+    }
+    return timeMax;
+}
+
+void ECLatencyHistogram::Print(std::ostream &os) const
+{
+    char line[128];
+    snprintf(line, sizeof(line), "%9lld %9.2f %7d %7d %7d %7d %7d", count, GetMean(), GetPercentile(50),
+             GetPercentile(90), GetPercentile(99), GetPercentile(99.9), timeMax);
+    os << line;
+}
+
+void ECLatencyHistogram::Save(ECSnapshotWriter &writer) const
+{
+    writer.WriteArray(listCounts);
+    writer.Write(count);
+    writer.Write(total);
+    writer.Write<int32_t>(timeMax);
+}
+
+bool ECLatencyHistogram::Restore(ECSnapshotReader &reader)
+{
+    int32_t timeMaxSaved = 0;
+    bool fOK = reader.ReadArray(listCounts) && reader.Read(count) && reader.Read(total) && reader.Read(timeMaxSaved) &&
+               (listCounts.empty() || listCounts.size() == EC_HIST_NUM_BUCKETS);
+    timeMax = timeMaxSaved;
+    return fOK;
+}
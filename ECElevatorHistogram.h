@@ -0,0 +1,84 @@
+//
+//  ECElevatorHistogram.h
+//
+//
+//  Log-bucketed histograms of times (wait, ride, trip)
+
+#ifndef ECElevatorHistogram_h
+#define ECElevatorHistogram_h
+
+#include "ECElevatorSnapshot.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+//*****************************************************************************
+// Counts of non-negative times in log-scaled buckets: times below 64 get one bucket
+// each, and every power of two above is split into 32 buckets, so a percentile is
+// within 1/32 (about 3%) of the exact value. Recording is O(1) and never allocates
+// after the first time; histograms of different runs merge by adding counts.
+// Count, total and max are exact
+
+class ECLatencyHistogram
+{
+public:
+    ECLatencyHistogram() : count(0), total(0), timeMax(0) {}
+
+    void Record(int time)
+    {
+        if (time < 0)
+        {
+            time = 0;
+        }
+        size_t bucket = GetBucket(time);
+        if (bucket >= listCounts.size())
+        {
+            listCounts.resize(EC_HIST_NUM_BUCKETS, 0);
+        }
+        ++listCounts[bucket];
+        ++count;
+        total += time;
+        if (time > timeMax)
+        {
+            timeMax = time;
+        }
+    }
+    void Merge(const ECLatencyHistogram &other);
+
+    long long GetCount() const { return count; }
+    double GetMean() const { return count > 0 ? (double)total / count : 0.0; }
+    int GetMax() const { return timeMax; }
+    // Time that p percent (0..100) of the recorded times do not exceed: the top of
+    // the bucket holding that rank, but no more than the max; 0 if empty
+    int GetPercentile(double p) const;
+
+    // "count mean p50 p90 p99 p99.9 max" on one line
+    void Print(std::ostream &os) const;
+
+    void Save(ECSnapshotWriter &writer) const;
+    bool Restore(ECSnapshotReader &reader);
+
+private:
+    enum
+    {
+        EC_HIST_SUB_BITS = 5,                               // 32 buckets per power of two
+        EC_HIST_NUM_BUCKETS = (32 - EC_HIST_SUB_BITS) * 32 // enough for any int
+    };
+    static size_t GetBucket(int time)
+    {
+        if (time < 64)
+        {
+            return time;
+        }
+        int exp = 31 - __builtin_clz((unsigned)time);
+        return (exp - EC_HIST_SUB_BITS) * 32 + (time >> (exp - EC_HIST_SUB_BITS));
+    }
+    static long long GetBucketTop(size_t bucket);
+
+    std::vector<long long> listCounts; // empty until the first time is recorded
+    long long count;
+    long long total;
+    int timeMax;
+};
+
+#endif /* ECElevatorHistogram_h */
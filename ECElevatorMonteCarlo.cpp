@@ -0,0 +1,115 @@
+//
+//  ECElevatorMonteCarlo.cpp
+//
+//
+//  Batches of randomized elevator simulations, spread over all cores
+
+#include "ECElevatorMonteCarlo.h"
+#include "ECElevatorWorkload.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+using namespace std;
+
+// splitmix64 of (seed, run): well-spread seeds even for consecutive runs
+uint64_t ECMonteCarloConfig::GetRunSeed(int run) const
+{
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (uint64_t)(run + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void ECMonteCarloConfig::MakeRequests(int run, std::vector<ECElevatorSimRequest> &listRequests) const
+{
+    if (workload)
+    {
+        workload(*this, GetRunSeed(run), listRequests);
+        return;
+    }
+
+    ECRandom rng(GetRunSeed(run));
+    listRequests.reserve(listRequests.size() + numRequests);
+    for (int i = 0; i < numRequests && numFloors > 1; ++i)
+    {
+        int time = rng.NextInt(max(timeArrivals, 1));
+        int floorSrc = 1 + rng.NextInt(numFloors);
+        // any other floor
+        int floorDest = 1 + rng.NextInt(numFloors - 1);
+        if (floorDest >= floorSrc)
+        {
+            ++floorDest;
+        }
+        listRequests.push_back(ECElevatorSimRequest(time, floorSrc, floorDest));
+    }
+}
+
+ECTimeSummary ECSummarizeTimes(const ECLatencyHistogram &hist)
+{
+    ECTimeSummary summary;
+    summary.mean = hist.GetMean();
+    summary.p50 = hist.GetPercentile(50);
+    summary.p90 = hist.GetPercentile(90);
+    summary.p99 = hist.GetPercentile(99);
+    summary.p999 = hist.GetPercentile(99.9);
+    summary.max = hist.GetMax();
+    return summary;
+}
+
+ECMonteCarloReport::ECMonteCarloReport(int numRuns, const ECElevatorSimStats &stats, double timeWall)
+    : numRuns(numRuns), numRequests(stats.GetNumRequests()), numServiced(stats.GetNumServiced()), timeWall(timeWall)
+{
+    summaryWait = ECSummarizeTimes(stats.GetWaitHistogram());
+    summaryRide = ECSummarizeTimes(stats.GetRideHistogram());
+    summaryTrip = ECSummarizeTimes(stats.GetTripHistogram());
+}
+
+void ECMonteCarloReport::Print(std::ostream &os) const
+{
+    os << "Runs: " << numRuns << "  requests: " << numRequests << "  serviced: " << numServiced << "\n";
+    os << "           mean     p50     p90     p99   p99.9     max\n";
+    const char *listNames[] = {"Wait", "Ride", "Trip"};
+    const ECTimeSummary *listSummaries[] = {&summaryWait, &summaryRide, &summaryTrip};
+    for (int i = 0; i < 3; ++i)
+    {
+        const ECTimeSummary &summary = *listSummaries[i];
+        char line[128];
+        snprintf(line, sizeof(line), "%-6s %9.2f %7d %7d %7d %7d %7d\n", listNames[i],
+                 summary.mean, summary.p50, summary.p90, summary.p99, summary.p999, summary.max);
+        os << line;
+    }
+    os << "Wall time: " << timeWall << " s\n";
+}
+
+ECElevatorSimStats ECRunBatch(int numRuns, int numThreads, const std::function<void(int run, ECElevatorSimStats &stats)> &job)
+{
+    if (numThreads <= 0)
+    {
+        numThreads = max(1u, thread::hardware_concurrency());
+    }
+    numThreads = min(numThreads, max(numRuns, 1));
+
+    // threads take the next run from a shared counter until all are taken
+    atomic<int> runNext(0);
+    vector<ECElevatorSimStats> listStats(numThreads);
+    vector<thread> listThreads;
+    for (int i = 0; i < numThreads; ++i)
+    {
+        listThreads.emplace_back([&, i]() {
+            for (int run = runNext++; run < numRuns; run = runNext++)
+            {
+                job(run, listStats[i]);
+            }
+        });
+    }
+
+    ECElevatorSimStats stats;
+    for (int i = 0; i < numThreads; ++i)
+    {
+        listThreads[i].join();
+        stats.Merge(listStats[i]);
+    }
+    return stats;
+}
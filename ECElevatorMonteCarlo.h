@@ -0,0 +1,107 @@
+//
+//  ECElevatorMonteCarlo.h
+//
+//
+//  Batches of randomized elevator simulations, spread over all cores
+
+#ifndef ECElevatorMonteCarlo_h
+#define ECElevatorMonteCarlo_h
+
+#include "ECElevatorSim.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+//*****************************************************************************
+// Settings of a batch: numRuns independent simulations of one building. Run i
+// gets its own workload made from the seed GetRunSeed(i), so the results don't
+// depend on how many threads run the batch
+
+struct ECMonteCarloConfig
+{
+    int numFloors = 10;
+    int numRequests = 100;      // requests per run
+    int timeArrivals = 1000;    // requests are made in [0, timeArrivals)
+    int timeDrain = 1000;       // simulate this long after timeArrivals so most passengers arrive
+    int numRuns = 100;
+    int numThreads = 0;         // 0: one per core
+    uint64_t seed = 1;
+
+    // workload of one run (default: uniform request times and floors, drawn with
+    // ECRandom so a seed gives the same requests with every standard library)
+    std::function<void(const ECMonteCarloConfig &config, uint64_t seed, std::vector<ECElevatorSimRequest> &listRequests)> workload;
+
+    int GetTimeSim() const { return timeArrivals + timeDrain; }
+    uint64_t GetRunSeed(int run) const;
+    void MakeRequests(int run, std::vector<ECElevatorSimRequest> &listRequests) const;
+};
+
+//*****************************************************************************
+// Mean and percentiles of a histogram of times
+
+struct ECTimeSummary
+{
+    double mean = 0.0;
+    int p50 = 0;
+    int p90 = 0;
+    int p99 = 0;
+    int p999 = 0;
+    int max = 0;
+};
+
+ECTimeSummary ECSummarizeTimes(const ECLatencyHistogram &hist);
+
+//*****************************************************************************
+// Merged statistics of a batch
+
+class ECMonteCarloReport
+{
+public:
+    ECMonteCarloReport(int numRuns, const ECElevatorSimStats &stats, double timeWall);
+
+    int GetNumRuns() const { return numRuns; }
+    long long GetNumRequests() const { return numRequests; }
+    long long GetNumServiced() const { return numServiced; }
+    const ECTimeSummary &GetWaitTime() const { return summaryWait; }
+    const ECTimeSummary &GetRideTime() const { return summaryRide; }
+    const ECTimeSummary &GetTripTime() const { return summaryTrip; }
+    double GetWallTime() const { return timeWall; }
+    void Print(std::ostream &os) const;
+
+private:
+    int numRuns;
+    long long numRequests;
+    long long numServiced;
+    ECTimeSummary summaryWait;
+    ECTimeSummary summaryRide;
+    ECTimeSummary summaryTrip;
+    double timeWall;
+};
+
+//*****************************************************************************
+// Thread pool for a batch: calls job(run, stats) for run = 0..numRuns-1 on
+// numThreads threads (0: one per core). Each thread adds to its own stats;
+// they are merged at the end
+
+ECElevatorSimStats ECRunBatch(int numRuns, int numThreads, const std::function<void(int run, ECElevatorSimStats &stats)> &job);
+
+// Run a batch with simulator TSim (e.g. ECElevatorSimLook) in next-event mode
+template<class TSim = ECElevatorSim>
+ECMonteCarloReport ECRunMonteCarlo(const ECMonteCarloConfig &config)
+{
+    auto timeStart = std::chrono::steady_clock::now();
+    ECElevatorSimStats stats = ECRunBatch(config.numRuns, config.numThreads, [&config](int run, ECElevatorSimStats &statsThread) {
+        std::vector<ECElevatorSimRequest> listRequests;
+        config.MakeRequests(run, listRequests);
+        TSim sim(config.numFloors, listRequests);
+        sim.SetTimeSkipping(true);
+        sim.Simulate(config.GetTimeSim());
+        statsThread.Merge(sim.GetStats());
+    });
+    std::chrono::duration<double> timeWall = std::chrono::steady_clock::now() - timeStart;
+    return ECMonteCarloReport(config.numRuns, stats, timeWall.count());
+}
+
+#endif /* ECElevatorMonteCarlo_h */
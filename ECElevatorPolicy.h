@@ -0,0 +1,167 @@
+//
+//  ECElevatorPolicy.h
+//
+//
+//  Scheduling policies for the elevator simulation
+
+#ifndef ECElevatorPolicy_h
+#define ECElevatorPolicy_h
+
+#include "ECElevatorSimTypes.h"
+
+//*****************************************************************************
+// A policy is a template parameter of ECElevatorSimT: its calls are resolved at
+// compile time and inlined into the simulation loop (no virtual dispatch).
+// A policy provides:
+// (i) DecideDirection(car): which way a stopped elevator with calls goes next
+// (ii) KeepGoing(car): after handling a floor, whether to keep moving in the
+// current direction. Must be true while there are calls ahead (time skipping
+// relies on this)
+// (iii) fDirectional: if true, waiting passengers only get in when the elevator
+// goes their way, or turns around at their floor
+//
+// The car passed in offers GetCurrFloor(), GetCurrDir(), GetLastDir(), GetNumFloors(),
+// HasCallAt(floor), FindCallAbove(floor) and FindCallBelow(floor) (-1 if none)
+
+//*****************************************************************************
+// Nearest call (default): a stopped elevator heads for the nearest floor with a
+// call (ties go up); keeps going while there are calls ahead
+
+class ECNearestCallPolicy
+{
+public:
+    static const bool fDirectional = false;
+
+    template<class TCar>
+    static EC_ELEVATOR_DIR DecideDirection(const TCar &car)
+    {
+        int floor = car.GetCurrFloor();
+        if (car.HasCallAt(floor))
+        {
+            return EC_ELEVATOR_DOWN;
+        }
+        int floorAbove = car.FindCallAbove(floor);
+        int floorBelow = car.FindCallBelow(floor);
+        if (floorAbove < 0 && floorBelow < 0)
+        {
+            return EC_ELEVATOR_STOPPED;
+        }
+        if (floorBelow < 0 || (floorAbove >= 0 && floorAbove - floor <= floor - floorBelow))
+        {
+            return EC_ELEVATOR_UP;
+        }
+        return EC_ELEVATOR_DOWN;
+    }
+
+    template<class TCar>
+    static bool KeepGoing(const TCar &car)
+    {
+        return HasCallAhead(car, car.GetCurrDir());
+    }
+
+    template<class TCar>
+    static bool HasCallAhead(const TCar &car, EC_ELEVATOR_DIR dir)
+    {
+        return (dir == EC_ELEVATOR_UP && car.FindCallAbove(car.GetCurrFloor()) >= 0) ||
+               (dir == EC_ELEVATOR_DOWN && car.FindCallBelow(car.GetCurrFloor()) >= 0);
+    }
+};
+
+//*****************************************************************************
+// LOOK: sweep in one direction while there are calls ahead, then reverse.
+// A stopped elevator keeps its last direction if there are calls that way
+
+class ECLookPolicy
+{
+public:
+    static const bool fDirectional = false;
+
+    template<class TCar>
+    static EC_ELEVATOR_DIR DecideDirection(const TCar &car)
+    {
+        EC_ELEVATOR_DIR dirLast = car.GetLastDir();
+        if (ECNearestCallPolicy::HasCallAhead(car, dirLast))
+        {
+            return dirLast;
+        }
+        EC_ELEVATOR_DIR dirOther = (dirLast == EC_ELEVATOR_UP) ? EC_ELEVATOR_DOWN : EC_ELEVATOR_UP;
+        if (dirLast != EC_ELEVATOR_STOPPED && ECNearestCallPolicy::HasCallAhead(car, dirOther))
+        {
+            return dirOther;
+        }
+        return ECNearestCallPolicy::DecideDirection(car);
+    }
+
+    template<class TCar>
+    static bool KeepGoing(const TCar &car)
+    {
+        return ECNearestCallPolicy::HasCallAhead(car, car.GetCurrDir());
+    }
+};
+
+//*****************************************************************************
+// SCAN: while there is any call, sweep all the way to the top (bottom) floor
+// before reversing
+
+class ECScanPolicy
+{
+public:
+    static const bool fDirectional = false;
+
+    template<class TCar>
+    static EC_ELEVATOR_DIR DecideDirection(const TCar &car)
+    {
+        int floor = car.GetCurrFloor();
+        if (!HasAnyCall(car))
+        {
+            return EC_ELEVATOR_STOPPED;
+        }
+        EC_ELEVATOR_DIR dirLast = car.GetLastDir();
+        if (floor >= car.GetNumFloors() || (dirLast == EC_ELEVATOR_DOWN && floor > 1))
+        {
+            return EC_ELEVATOR_DOWN;
+        }
+        if (floor <= 1 || dirLast == EC_ELEVATOR_UP)
+        {
+            return EC_ELEVATOR_UP;
+        }
+        return ECNearestCallPolicy::DecideDirection(car);
+    }
+
+    template<class TCar>
+    static bool KeepGoing(const TCar &car)
+    {
+        return HasAnyCall(car);
+    }
+
+    template<class TCar>
+    static bool HasAnyCall(const TCar &car)
+    {
+        int floor = car.GetCurrFloor();
+        return car.HasCallAt(floor) || car.FindCallAbove(floor) >= 0 || car.FindCallBelow(floor) >= 0;
+    }
+};
+
+//*****************************************************************************
+// Collective control: moves like LOOK, but going up it only picks up passengers
+// going up (and vice versa); at the floor where it turns around it takes everyone
+
+class ECCollectivePolicy
+{
+public:
+    static const bool fDirectional = true;
+
+    template<class TCar>
+    static EC_ELEVATOR_DIR DecideDirection(const TCar &car)
+    {
+        return ECLookPolicy::DecideDirection(car);
+    }
+
+    template<class TCar>
+    static bool KeepGoing(const TCar &car)
+    {
+        return ECLookPolicy::KeepGoing(car);
+    }
+};
+
+#endif /* ECElevatorPolicy_h */
@@ -0,0 +1,52 @@
+//
+//  ECElevatorProfiler.cpp
+//
+//
+//  Where the simulation loop spends its time
+
+#include "ECElevatorProfiler.h"
+#include <cstdio>
+
+using namespace std;
+
+void ECPhaseProfiler::Reset()
+{
+    for (int i = 0; i < EC_NUM_PHASES; ++i)
+    {
+        listCalls[i] = 0;
+        listItems[i] = 0;
+        listCycles[i] = 0;
+    }
+}
+
+void ECPhaseProfiler::Merge(const ECPhaseProfiler &other)
+{
+    for (int i = 0; i < EC_NUM_PHASES; ++i)
+    {
+        listCalls[i] += other.listCalls[i];
+        listItems[i] += other.listItems[i];
+        listCycles[i] += other.listCycles[i];
+    }
+}
+
+const char *ECPhaseProfiler::GetPhaseName(EC_SIM_PHASE phase)
+{
+    static const char *listNames[EC_NUM_PHASES] = {"CollectRequests", "HandlePassengers", "DecideDirection",
+                                                   "HasFurtherRequests", "MoveOneFloor"};
+    return listNames[phase];
+}
+
+void ECPhaseProfiler::Print(std::ostream &os) const
+{
+    os << "Phase                     calls        items          cycles  cycles/call  items/call\n";
+    for (int i = 0; i < EC_NUM_PHASES; ++i)
+    {
+        double numCalls = listCalls[i] > 0 ? (double)listCalls[i] : 1.0;
+        char line[160];
+        snprintf(line, sizeof(line), "%-20s %10lld %12lld %15llu %12.1f %11.2f\n", GetPhaseName((EC_SIM_PHASE)i),
+                 listCalls[i], listItems[i], (unsigned long long)listCycles[i], listCycles[i] / numCalls,
+                 listItems[i] / numCalls);
+        os << line;
+    }
+    os << "(MoveOneFloor includes the CollectRequests, HandlePassengers and HasFurtherRequests calls it makes)\n";
+}
@@ -0,0 +1,101 @@
+//
+//  ECElevatorProfiler.h
+//
+//
+//  Where the simulation loop spends its time
+
+#ifndef ECElevatorProfiler_h
+#define ECElevatorProfiler_h
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//*****************************************************************************
+// Phases of the simulation loop. MoveOneFloor includes the phases it calls
+// (collecting requests and handling passengers at the new floor)
+
+typedef enum
+{
+    EC_PHASE_COLLECT_REQUESTS = 0,
+    EC_PHASE_HANDLE_PASSENGERS,
+    EC_PHASE_DECIDE_DIRECTION,
+    EC_PHASE_HAS_FURTHER_REQUESTS,
+    EC_PHASE_MOVE_ONE_FLOOR,
+    EC_NUM_PHASES
+} EC_SIM_PHASE;
+
+//*****************************************************************************
+// A profiler is the second template parameter of ECElevatorSimT. The simulator
+// opens a Scope for the duration of each phase and reports the items (requests,
+// passengers, floors) the phase went through with AddItems.
+// ECNoProfiler (the default) does nothing, and compiles out entirely
+
+class ECNoProfiler
+{
+public:
+    static const bool fEnabled = false;
+    class Scope
+    {
+    public:
+        Scope(ECNoProfiler &, EC_SIM_PHASE) {}
+    };
+    void AddItems(EC_SIM_PHASE, long long) {}
+    void Print(std::ostream &) const {}
+};
+
+//*****************************************************************************
+// Calls, items and cycles (time stamp counter; nanoseconds where there is none)
+// per phase
+
+class ECPhaseProfiler
+{
+public:
+    static const bool fEnabled = true;
+    class Scope
+    {
+    public:
+        Scope(ECPhaseProfiler &profiler, EC_SIM_PHASE phase) : profiler(profiler), phase(phase), cycleStart(GetCycles())
+        {
+            ++profiler.listCalls[phase];
+        }
+        ~Scope() { profiler.listCycles[phase] += GetCycles() - cycleStart; }
+
+    private:
+        ECPhaseProfiler &profiler;
+        EC_SIM_PHASE phase;
+        uint64_t cycleStart;
+    };
+
+    ECPhaseProfiler() { Reset(); }
+    void AddItems(EC_SIM_PHASE phase, long long num) { listItems[phase] += num; }
+    void Reset();
+    void Merge(const ECPhaseProfiler &other);
+
+    long long GetNumCalls(EC_SIM_PHASE phase) const { return listCalls[phase]; }
+    long long GetNumItems(EC_SIM_PHASE phase) const { return listItems[phase]; }
+    uint64_t GetNumCycles(EC_SIM_PHASE phase) const { return listCycles[phase]; }
+    static const char *GetPhaseName(EC_SIM_PHASE phase);
+
+    // One line per phase: calls, items, cycles, and cycles and items per call
+    void Print(std::ostream &os) const;
+
+    static uint64_t GetCycles()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+private:
+    long long listCalls[EC_NUM_PHASES];
+    long long listItems[EC_NUM_PHASES];
+    uint64_t listCycles[EC_NUM_PHASES];
+};
+
+#endif /* ECElevatorProfiler_h */
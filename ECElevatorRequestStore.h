@@ -0,0 +1,197 @@
+//
+//  ECElevatorRequestStore.h
+//
+//
+//  Compact storage of elevator requests
+
+#ifndef ECElevatorRequestStore_h
+#define ECElevatorRequestStore_h
+
+#include "ECElevatorSimTypes.h"
+#include "ECElevatorSnapshot.h"
+#include <cstdint>
+#include <vector>
+
+//*****************************************************************************
+// Requests stored column by column (structure of arrays) and addressed by index:
+// 4-byte time, 2-byte floors, 4-byte board and arrive times and one byte of status
+// bits, 17 bytes a request (ECElevatorSimRequest takes 20 and has no board time). Floors must fit in
+// 16 bits; others are stored as an invalid floor (so the request is never serviced)
+
+class ECElevatorRequestStore
+{
+public:
+    ECElevatorRequestStore() : fSortedByTime(true) {}
+    explicit ECElevatorRequestStore(const std::vector<ECElevatorSimRequest> &listRequests) : fSortedByTime(true)
+    {
+        Reserve(listRequests.size());
+        for (const auto &request : listRequests)
+        {
+            Add(request);
+        }
+    }
+
+    void Reserve(size_t n)
+    {
+        listTime.reserve(n);
+        listFloorSrc.reserve(n);
+        listFloorDest.reserve(n);
+        listTimeBoard.reserve(n);
+        listTimeArrive.reserve(n);
+        listStatus.reserve(n);
+    }
+    // Add a request; returns its index
+    int Add(int time, int floorSrc, int floorDest)
+    {
+        if (!listTime.empty() && time < listTime.back())
+        {
+            fSortedByTime = false;
+        }
+        listTime.push_back(time);
+        listFloorSrc.push_back(ToFloor(floorSrc));
+        listFloorDest.push_back(ToFloor(floorDest));
+        listTimeBoard.push_back(-1);
+        listTimeArrive.push_back(-1);
+        listStatus.push_back(0);
+        return (int)listTime.size() - 1;
+    }
+    // Add a copy of request (status and arrive time included)
+    int Add(const ECElevatorSimRequest &request)
+    {
+        int i = Add(request.GetTime(), request.GetFloorSrc(), request.GetFloorDest());
+        SetFloorRequestDone(i, request.IsFloorRequestDone());
+        SetServiced(i, request.IsServiced());
+        SetArriveTime(i, request.GetArriveTime());
+        return i;
+    }
+    // Reuse index i for another request (status, board and arrive time are reset); the
+    // store no longer counts as sorted
+    void Set(int i, int time, int floorSrc, int floorDest)
+    {
+        listTime[i] = time;
+        listFloorSrc[i] = ToFloor(floorSrc);
+        listFloorDest[i] = ToFloor(floorDest);
+        listTimeBoard[i] = -1;
+        listTimeArrive[i] = -1;
+        listStatus[i] = 0;
+        fSortedByTime = false;
+    }
+    void Clear()
+    {
+        listTime.clear();
+        listFloorSrc.clear();
+        listFloorDest.clear();
+        listTimeBoard.clear();
+        listTimeArrive.clear();
+        listStatus.clear();
+        fSortedByTime = true;
+    }
+
+    size_t GetSize() const { return listTime.size(); }
+    // true if no request was added before an earlier one
+    bool IsSortedByTime() const { return fSortedByTime; }
+    size_t GetMemoryBytes() const
+    {
+        return listTime.capacity() * sizeof(int32_t) + (listFloorSrc.capacity() + listFloorDest.capacity()) * sizeof(int16_t) +
+               (listTimeBoard.capacity() + listTimeArrive.capacity()) * sizeof(int32_t) + listStatus.capacity();
+    }
+
+    // Same accessors as ECElevatorSimRequest, by index
+    int GetTime(int i) const { return listTime[i]; }
+    int GetFloorSrc(int i) const { return listFloorSrc[i]; }
+    int GetFloorDest(int i) const { return listFloorDest[i]; }
+    bool IsGoingUp(int i) const { return listFloorDest[i] >= listFloorSrc[i]; }
+    bool IsFloorRequestDone(int i) const { return (listStatus[i] & EC_REQ_FLOOR_DONE) != 0; }
+    void SetFloorRequestDone(int i, bool f) { SetStatus(i, EC_REQ_FLOOR_DONE, f); }
+    bool IsServiced(int i) const { return (listStatus[i] & EC_REQ_SERVICED) != 0; }
+    void SetServiced(int i, bool f) { SetStatus(i, EC_REQ_SERVICED, f); }
+    int GetArriveTime(int i) const { return listTimeArrive[i]; }
+    void SetArriveTime(int i, int t) { listTimeArrive[i] = t; }
+    // when the passenger got in (-1: not yet)
+    int GetBoardTime(int i) const { return listTimeBoard[i]; }
+    void SetBoardTime(int i, int t) { listTimeBoard[i] = t; }
+    int GetRequestedFloor(int i) const
+    {
+        return IsServiced(i) ? -1 : (IsFloorRequestDone(i) ? GetFloorDest(i) : GetFloorSrc(i));
+    }
+
+    // All columns, for simulation snapshots
+    void Save(ECSnapshotWriter &writer) const
+    {
+        writer.WriteArray(listTime);
+        writer.WriteArray(listFloorSrc);
+        writer.WriteArray(listFloorDest);
+        writer.WriteArray(listTimeBoard);
+        writer.WriteArray(listTimeArrive);
+        writer.WriteArray(listStatus);
+        writer.Write<uint8_t>(fSortedByTime);
+    }
+    bool Restore(ECSnapshotReader &reader)
+    {
+        uint8_t fSorted = 0;
+        if (!reader.ReadArray(listTime) || !reader.ReadArray(listFloorSrc) || !reader.ReadArray(listFloorDest) ||
+            !reader.ReadArray(listTimeBoard) || !reader.ReadArray(listTimeArrive) || !reader.ReadArray(listStatus) || !reader.Read(fSorted))
+        {
+            return false;
+        }
+        fSortedByTime = fSorted != 0;
+        size_t num = listTime.size();
+        return listFloorSrc.size() == num && listFloorDest.size() == num && listTimeBoard.size() == num &&
+               listTimeArrive.size() == num && listStatus.size() == num;
+    }
+
+    // Copy of request i as an ECElevatorSimRequest
+    ECElevatorSimRequest GetRequest(int i) const
+    {
+        ECElevatorSimRequest request(GetTime(i), GetFloorSrc(i), GetFloorDest(i));
+        request.SetFloorRequestDone(IsFloorRequestDone(i));
+        request.SetServiced(IsServiced(i));
+        request.SetArriveTime(GetArriveTime(i));
+        return request;
+    }
+
+private:
+    enum
+    {
+        EC_REQ_FLOOR_DONE = 1,
+        EC_REQ_SERVICED = 2
+    };
+    void SetStatus(int i, uint8_t bit, bool f) { listStatus[i] = f ? (listStatus[i] | bit) : (listStatus[i] & ~bit); }
+    static int16_t ToFloor(int floor) { return (floor >= INT16_MIN && floor <= INT16_MAX) ? (int16_t)floor : INT16_MIN; }
+
+    std::vector<int32_t> listTime;
+    std::vector<int16_t> listFloorSrc;
+    std::vector<int16_t> listFloorDest;
+    std::vector<int32_t> listTimeBoard;
+    std::vector<int32_t> listTimeArrive;
+    std::vector<uint8_t> listStatus;
+    bool fSortedByTime;
+};
+
+//*****************************************************************************
+// One request of a store, seen through the accessors of ECElevatorSimRequest
+
+class ECElevatorRequestRef
+{
+public:
+    ECElevatorRequestRef(ECElevatorRequestStore &store, int index) : store(&store), index(index) {}
+    int GetIndex() const { return index; }
+    int GetTime() const { return store->GetTime(index); }
+    int GetFloorSrc() const { return store->GetFloorSrc(index); }
+    int GetFloorDest() const { return store->GetFloorDest(index); }
+    bool IsGoingUp() const { return store->IsGoingUp(index); }
+    bool IsFloorRequestDone() const { return store->IsFloorRequestDone(index); }
+    void SetFloorRequestDone(bool f) { store->SetFloorRequestDone(index, f); }
+    bool IsServiced() const { return store->IsServiced(index); }
+    void SetServiced(bool f) { store->SetServiced(index, f); }
+    int GetRequestedFloor() const { return store->GetRequestedFloor(index); }
+    int GetArriveTime() const { return store->GetArriveTime(index); }
+    void SetArriveTime(int t) { store->SetArriveTime(index, t); }
+    int GetBoardTime() const { return store->GetBoardTime(index); }
+
+private:
+    ECElevatorRequestStore *store;
+    int index;
+};
+
+#endif /* ECElevatorRequestStore_h */
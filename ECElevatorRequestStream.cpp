@@ -0,0 +1,133 @@
+//
+//  ECElevatorRequestStream.cpp
+//
+//
+//  Requests read as the simulation goes, and written out once done
+
+#include "ECElevatorSim.h"
+#include <charconv>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+static inline bool IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char *ECParseRequestLine(const char *pos, const char *end, int *listValues, int count, bool &fEmpty, bool &fValid)
+{
+    while (pos < end && IsBlank(*pos))
+    {
+        ++pos;
+    }
+    fEmpty = pos == end || *pos == '\n' || *pos == '#';
+    fValid = !fEmpty;
+    for (int i = 0; i < count && fValid; ++i)
+    {
+        while (pos < end && IsBlank(*pos))
+        {
+            ++pos;
+        }
+        from_chars_result result = from_chars(pos, end, listValues[i]);
+        fValid = result.ec == errc() && (result.ptr == end || IsBlank(*result.ptr) || *result.ptr == '\n' || *result.ptr == '#');
+        pos = result.ptr;
+    }
+    while (fValid && pos < end && IsBlank(*pos))
+    {
+        ++pos;
+    }
+    fValid = fValid && (pos == end || *pos == '\n' || *pos == '#');
+
+    const char *posNewline = static_cast<const char *>(memchr(pos, '\n', end - pos));
+    return posNewline != nullptr ? posNewline + 1 : end;
+}
+
+ECRequestReader::ECRequestReader(std::istream &is) : is(is), numFloors(0), timeSim(0), numLine(0)
+{
+    int listValues[2];
+    bool fValid;
+    if (!GetNextLine(listValues, 2, fValid))
+    {
+        return;
+    }
+    if (!fValid || !ECIsHeaderLineValid(listValues))
+    {
+        strError = "line " + to_string(numLine) + ": header is not \"numFloors timeSim\" with 1 to 32767 floors";
+        return;
+    }
+    numFloors = listValues[0];
+    timeSim = listValues[1];
+}
+
+bool ECRequestReader::GetNext(int &time, int &floorSrc, int &floorDest)
+{
+    int listValues[3];
+    bool fValid;
+    if (HasError() || !GetNextLine(listValues, 3, fValid))
+    {
+        return false;
+    }
+    if (!fValid || !ECIsRequestLineValid(listValues))
+    {
+        strError = "line " + to_string(numLine) + ": " + (fValid ? "floor out of range" : "expected \"time floorSrc floorDest\"");
+        return false;
+    }
+    time = listValues[0];
+    floorSrc = listValues[1];
+    floorDest = listValues[2];
+    return true;
+}
+
+// Next line that is not blank or a comment, read as count numbers
+bool ECRequestReader::GetNextLine(int *listValues, int count, bool &fValid)
+{
+    bool fEmpty = true;
+    while (fEmpty && getline(is, line))
+    {
+        ++numLine;
+        ECParseRequestLine(line.data(), line.data() + line.size(), listValues, count, fEmpty, fValid);
+    }
+    return !fEmpty;
+}
+
+void ECRequestWriter::Put(const ECElevatorSimRequest &request)
+{
+    os << request.GetTime() << ' ' << request.GetFloorSrc() << ' ' << request.GetFloorDest() << ' '
+       << request.GetArriveTime() << '\n';
+}
+
+ECRequestFileWriter::ECRequestFileWriter(std::ostream &os, int numFloors, int timeSim) : os(os), buffer(1 << 16), size(0)
+{
+    WriteInt(numFloors);
+    buffer[size++] = ' ';
+    WriteInt(timeSim);
+    buffer[size++] = '\n';
+}
+
+void ECRequestFileWriter::Write(int time, int floorSrc, int floorDest)
+{
+    // a line is at most 3 numbers of 11 characters and 3 separators
+    if (buffer.size() - size < 40)
+    {
+        Flush();
+    }
+    WriteInt(time);
+    buffer[size++] = ' ';
+    WriteInt(floorSrc);
+    buffer[size++] = ' ';
+    WriteInt(floorDest);
+    buffer[size++] = '\n';
+}
+
+void ECRequestFileWriter::Flush()
+{
+    os.write(buffer.data(), size);
+    size = 0;
+}
+
+void ECRequestFileWriter::WriteInt(int value)
+{
+    size = to_chars(buffer.data() + size, buffer.data() + buffer.size(), value).ptr - buffer.data();
+}
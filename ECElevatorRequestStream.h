@@ -0,0 +1,160 @@
+//
+//  ECElevatorRequestStream.h
+//
+//
+//  Requests read as the simulation goes, and written out once done
+
+#ifndef ECElevatorRequestStream_h
+#define ECElevatorRequestStream_h
+
+#include "ECElevatorSimTypes.h"
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Forward-only source of requests, in time order. The simulator only pulls the
+// next request once simulated time gets close to it
+
+class ECRequestSource
+{
+public:
+    virtual ~ECRequestSource() {}
+    // next request; false when there are no more
+    virtual bool GetNext(int &time, int &floorSrc, int &floorDest) = 0;
+};
+
+//*****************************************************************************
+// Where finished requests go: serviced ones (with their arrive time), and ones
+// that will never be serviced (made too late or for floors outside the building)
+
+class ECRequestSink
+{
+public:
+    virtual ~ECRequestSink() {}
+    virtual void Put(const ECElevatorSimRequest &request) = 0;
+};
+
+//*****************************************************************************
+// Requests in [itBegin, itEnd) of anything holding ECElevatorSimRequest
+
+template<class TIterator>
+class ECIteratorRequestSource : public ECRequestSource
+{
+public:
+    ECIteratorRequestSource(TIterator itBegin, TIterator itEnd) : itCurr(itBegin), itEnd(itEnd) {}
+    bool GetNext(int &time, int &floorSrc, int &floorDest) override
+    {
+        if (itCurr == itEnd)
+        {
+            return false;
+        }
+        time = itCurr->GetTime();
+        floorSrc = itCurr->GetFloorSrc();
+        floorDest = itCurr->GetFloorDest();
+        ++itCurr;
+        return true;
+    }
+
+private:
+    TIterator itCurr;
+    TIterator itEnd;
+};
+
+//*****************************************************************************
+// Requests made up on the fly by a function (e.g. a random workload)
+
+class ECGeneratorRequestSource : public ECRequestSource
+{
+public:
+    typedef std::function<bool(int &time, int &floorSrc, int &floorDest)> Generator;
+    explicit ECGeneratorRequestSource(Generator generator) : generator(generator) {}
+    bool GetNext(int &time, int &floorSrc, int &floorDest) override { return generator(time, floorSrc, floorDest); }
+
+private:
+    Generator generator;
+};
+
+//*****************************************************************************
+// Lines of a request file, the same for every reader: blank lines and comments
+// (from a '#', after blanks or after the numbers) are skipped; the first other
+// line is the header "numFloors timeSim" (1 to 32767 floors, time not negative),
+// then one "time floorSrc floorDest" line per request (floors fit in 16 bits)
+
+// Reads count numbers from the line at pos (it ends at '\n' or end); returns where
+// the next line starts. fEmpty: the line is blank or a comment. fValid: the line is
+// count numbers, then nothing but blanks or a comment
+const char *ECParseRequestLine(const char *pos, const char *end, int *listValues, int count, bool &fEmpty, bool &fValid);
+inline bool ECIsHeaderLineValid(const int *listValues)
+{
+    return listValues[0] >= 1 && listValues[0] <= INT16_MAX && listValues[1] >= 0;
+}
+inline bool ECIsRequestLineValid(const int *listValues)
+{
+    return listValues[1] >= INT16_MIN && listValues[1] <= INT16_MAX && listValues[2] >= INT16_MIN && listValues[2] <= INT16_MAX;
+}
+
+//*****************************************************************************
+// Requests read from a request file, one line at a time. Reading stops at the first
+// bad line, with the reason (and line) in GetError(), as ECLoadRequestFile reports it
+
+class ECRequestReader : public ECRequestSource
+{
+public:
+    explicit ECRequestReader(std::istream &is);
+    // from the header line (0 if missing or bad)
+    int GetNumFloors() const { return numFloors; }
+    int GetTimeSim() const { return timeSim; }
+    bool GetNext(int &time, int &floorSrc, int &floorDest) override;
+    bool HasError() const { return !strError.empty(); }
+    const std::string &GetError() const { return strError; }
+
+private:
+    bool GetNextLine(int *listValues, int count, bool &fValid);
+
+    std::istream &is;
+    std::string line;
+    int numFloors;
+    int timeSim;
+    int numLine;
+    std::string strError;
+};
+
+//*****************************************************************************
+// Finished requests written one per line: "time floorSrc floorDest timeArrive"
+// (timeArrive is -1 if the request was never serviced)
+
+class ECRequestWriter : public ECRequestSink
+{
+public:
+    explicit ECRequestWriter(std::ostream &os) : os(os) {}
+    void Put(const ECElevatorSimRequest &request) override;
+
+private:
+    std::ostream &os;
+};
+
+//*****************************************************************************
+// Requests written as a request file (what ECRequestReader reads), through a
+// buffer: traces of many millions of requests are written in large blocks
+
+class ECRequestFileWriter
+{
+public:
+    // writes the header line
+    ECRequestFileWriter(std::ostream &os, int numFloors, int timeSim);
+    ~ECRequestFileWriter() { Flush(); }
+    void Write(int time, int floorSrc, int floorDest);
+    void Flush();
+
+private:
+    void WriteInt(int value);
+
+    std::ostream &os;
+    std::vector<char> buffer;
+    size_t size;
+};
+
+#endif /* ECElevatorRequestStream_h */
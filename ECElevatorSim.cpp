@@ -7,23 +7,90 @@
 
 #include "ECElevatorSim.h"
 #include <algorithm>
-#include <unordered_set>
+#include <climits>
+#include <cstring>
 
 using namespace std;
 
 // Constructor
-ECElevatorSim::ECElevatorSim(int numFloors, std::vector<ECElevatorSimRequest> &listRequests)
-    : ElevatorBase(numFloors), timeElapsed(0), listRequests(listRequests)
+template<class TPolicy, class TProfiler>
+ECElevatorSimT<TPolicy, TProfiler>::ECElevatorSimT(int numFloors, std::vector<ECElevatorSimRequest> &listRequests, bool fAllRequests)
+    : ElevatorBase(numFloors), timeElapsed(0), fTimeSkipping(false), lastDir(EC_ELEVATOR_STOPPED),
+      storeOwned(listRequests), store(storeOwned), pListRequests(&listRequests),
+      pSource(nullptr), pSink(nullptr), fHasNext(false), timeNext(0), floorSrcNext(0), floorDestNext(0), numTaken(0),
+      fArrivalsInStoreOrder(false), arrivalCursor(0), arrivalTickBegin(0), timeCollected(-1),
+      waitingUpAtFloor(numFloors + 1), waitingDownAtFloor(numFloors + 1), cabinToFloor(numFloors + 1),
+      listNextWaiting(listRequests.size(), -1), listNextInCabin(listRequests.size(), -1),
+      numWaiting(0), numInCabin(0), hallCalls(numFloors), hallCallsUp(numFloors), hallCallsDown(numFloors),
+      carCalls(numFloors)
+{
+    InitArrivals(fAllRequests);
+}
+
+template<class TPolicy, class TProfiler>
+ECElevatorSimT<TPolicy, TProfiler>::ECElevatorSimT(int numFloors, ECElevatorRequestStore &store, bool fAllRequests,
+                                        std::vector<ECElevatorSimRequest> *pListRequests)
+    : ElevatorBase(numFloors), timeElapsed(0), fTimeSkipping(false), lastDir(EC_ELEVATOR_STOPPED),
+      store(store), pListRequests(pListRequests),
+      pSource(nullptr), pSink(nullptr), fHasNext(false), timeNext(0), floorSrcNext(0), floorDestNext(0), numTaken(0),
+      fArrivalsInStoreOrder(false), arrivalCursor(0), arrivalTickBegin(0), timeCollected(-1),
+      waitingUpAtFloor(numFloors + 1), waitingDownAtFloor(numFloors + 1), cabinToFloor(numFloors + 1),
+      listNextWaiting(store.GetSize(), -1), listNextInCabin(store.GetSize(), -1),
+      numWaiting(0), numInCabin(0), hallCalls(numFloors), hallCallsUp(numFloors), hallCallsDown(numFloors),
+      carCalls(numFloors)
+{
+    InitArrivals(fAllRequests);
+}
+
+template<class TPolicy, class TProfiler>
+ECElevatorSimT<TPolicy, TProfiler>::ECElevatorSimT(int numFloors, ECRequestSource &source, ECRequestSink &sink)
+    : ElevatorBase(numFloors), timeElapsed(0), fTimeSkipping(false), lastDir(EC_ELEVATOR_STOPPED),
+      store(storeOwned), pListRequests(nullptr),
+      pSource(&source), pSink(&sink), fHasNext(false), timeNext(0), floorSrcNext(0), floorDestNext(0), numTaken(0),
+      fArrivalsInStoreOrder(false), arrivalCursor(0), arrivalTickBegin(0), timeCollected(-1),
+      waitingUpAtFloor(numFloors + 1), waitingDownAtFloor(numFloors + 1), cabinToFloor(numFloors + 1),
+      numWaiting(0), numInCabin(0), hallCalls(numFloors), hallCallsUp(numFloors), hallCallsDown(numFloors),
+      carCalls(numFloors)
+{
+    InitArrivals(false);
+    PullNext();
+}
+
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::InitArrivals(bool fAllRequests)
 {
     currFloor = 1; // Start at floor 1
     currDir = EC_ELEVATOR_STOPPED;
+
+    if (!fAllRequests)
+    {
+        return;
+    }
+    if (store.IsSortedByTime())
+    {
+        fArrivalsInStoreOrder = true;
+        return;
+    }
+
+    // index requests by arrival time (stable, so same-time requests keep their input order)
+    arrivalOrder.resize(store.GetSize());
+    for (size_t i = 0; i < arrivalOrder.size(); ++i)
+    {
+        arrivalOrder[i] = (int)i;
+    }
+    const ECElevatorRequestStore &storeSort = store;
+    stable_sort(arrivalOrder.begin(), arrivalOrder.end(), [&storeSort](int a, int b) {
+        return storeSort.GetTime(a) < storeSort.GetTime(b);
+    });
 }
 
 // Destructor
-ECElevatorSim::~ECElevatorSim() {}
+template<class TPolicy, class TProfiler>
+ECElevatorSimT<TPolicy, TProfiler>::~ECElevatorSimT() {}
 
 //elevator
-void ECElevatorSim::Simulate(int lenSim)
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::Simulate(int lenSim)
 {
     while (timeElapsed < lenSim)
     {
@@ -31,23 +98,37 @@ void ECElevatorSim::Simulate(int lenSim)
 
         if (currDir != EC_ELEVATOR_STOPPED)
         {
-            MoveOneFloor();
+            if (!fTimeSkipping || !SkipFloors(lenSim))
+            {
+                MoveOneFloor();
+            }
         }
         else
         {
             // elevator is stopped
-            if (!pendingRequests.empty() || !passengersInCabin.empty())
+            if (numWaiting > 0 || numInCabin > 0)
             {
                 DecideDirection();
                 if (currDir != EC_ELEVATOR_STOPPED)
                 {
-                    MoveOneFloor();
+                    if (!fTimeSkipping || !SkipFloors(lenSim))
+                    {
+                        MoveOneFloor();
+                    }
+                }
+                else if (fTimeSkipping)
+                {
+                    SkipIdle(lenSim);
                 }
                 else
                 {
                     ++timeElapsed;
                 }
             }
+            else if (fTimeSkipping)
+            {
+                SkipIdle(lenSim);
+            }
             else
             {
                 ++timeElapsed;
@@ -56,27 +137,330 @@ void ECElevatorSim::Simulate(int lenSim)
     }
 }
 
-void ECElevatorSim::CollectRequests(int currentTime)
+// Time of the next request not collected yet (INT_MAX if none)
+template<class TPolicy, class TProfiler>
+int ECElevatorSimT<TPolicy, TProfiler>::GetNextArrivalTime() const
+{
+    if (pSource != nullptr)
+    {
+        return fHasNext ? timeNext : INT_MAX;
+    }
+    if (arrivalCursor < GetNumArrivals())
+    {
+        return store.GetTime(GetArrival(arrivalCursor));
+    }
+    return INT_MAX;
+}
+
+// Nothing to do until the next request: jump straight to it
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::SkipIdle(int lenSim)
 {
-    for (auto &request : listRequests)
+    timeElapsed = max(timeElapsed + 1, min(GetNextArrivalTime(), lenSim));
+}
+
+// Cross the floors before the next stop in one step. Stops only when nothing
+// can happen on the way: no passenger gets in or out and no request arrives.
+// Returns false if the next floor needs to be handled by MoveOneFloor
+template<class TPolicy, class TProfiler>
+bool ECElevatorSimT<TPolicy, TProfiler>::SkipFloors(int lenSim)
+{
+    int distance = GetDistanceToNextStop();
+    if (distance > numFloors)
+    {
+        return false;
+    }
+    int numSkip = min(distance - 1, lenSim - timeElapsed);
+    if (GetNextArrivalTime() != INT_MAX)
     {
-        if (request.GetTime() == currentTime && !request.IsServiced())
+        numSkip = min(numSkip, GetNextArrivalTime() - timeElapsed - 1);
+    }
+    if (numSkip <= 0)
+    {
+        return false;
+    }
+
+    currFloor += (currDir == EC_ELEVATOR_UP) ? numSkip : -numSkip;
+    timeElapsed += numSkip;
+    CollectRequests(timeElapsed);
+    return true;
+}
+
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::CollectRequests(int currentTime)
+{
+    typename TProfiler::Scope scope(profiler, EC_PHASE_COLLECT_REQUESTS);
+    if (currentTime == timeCollected)
+    {
+        // already collected at this time (e.g. right after a move); the elevator may
+        // have stopped since, so requests made at this floor can get in directly
+        if (currDir != EC_ELEVATOR_STOPPED)
         {
-            if (request.GetFloorSrc() == currFloor && currDir == EC_ELEVATOR_STOPPED)
-            {
-                request.SetFloorRequestDone(true);
-                passengersInCabin.push_back(&request);
-            }
-            else
+            return;
+        }
+        profiler.AddItems(EC_PHASE_COLLECT_REQUESTS, arrivalCursor - arrivalTickBegin);
+        for (size_t i = arrivalTickBegin; i < arrivalCursor; ++i)
+        {
+            int req = GetArrival(i);
+            if (store.GetFloorSrc(req) == currFloor && !store.IsFloorRequestDone(req) && !store.IsServiced(req) &&
+                IsValidRequest(store.GetFloorSrc(req), store.GetFloorDest(req)))
             {
-                pendingRequests.push_back(&request);
+                DropWaiting(req);
+                BoardRequest(req);
             }
         }
+        return;
+    }
+
+    // time only moves forward: skip requests made before now (never collected)
+    while (GetNextArrivalTime() < currentTime)
+    {
+        SkipArrival();
+        profiler.AddItems(EC_PHASE_COLLECT_REQUESTS, 1);
+    }
+
+    timeCollected = currentTime;
+    if (pSource != nullptr)
+    {
+        arrivalOrder.clear();
+        arrivalCursor = 0;
+    }
+    arrivalTickBegin = arrivalCursor;
+    while (GetNextArrivalTime() == currentTime)
+    {
+        int req = TakeArrival();
+        profiler.AddItems(EC_PHASE_COLLECT_REQUESTS, 1);
+        // requests for floors outside the building are never serviced
+        if (req < 0 || store.IsServiced(req) || !IsValidRequest(store.GetFloorSrc(req), store.GetFloorDest(req)))
+        {
+            continue;
+        }
+        stats.AddRequest();
+        if (store.GetFloorSrc(req) == currFloor && currDir == EC_ELEVATOR_STOPPED)
+        {
+            BoardRequest(req);
+        }
+        else
+        {
+            PushWaiting(req);
+        }
+    }
+}
+
+template<class TPolicy, class TProfiler>
+bool ECElevatorSimT<TPolicy, TProfiler>::IsValidRequest(int floorSrc, int floorDest) const
+{
+    return floorSrc != floorDest && floorSrc >= 1 && floorSrc <= numFloors && floorDest >= 1 && floorDest <= numFloors;
+}
+
+// Next request in time order, now collected. When streaming it gets a free index
+// in the store (-1 if it can never be serviced: it goes straight to the sink)
+template<class TPolicy, class TProfiler>
+int ECElevatorSimT<TPolicy, TProfiler>::TakeArrival()
+{
+    if (pSource == nullptr)
+    {
+        return GetArrival(arrivalCursor++);
+    }
+
+    if (!IsValidRequest(floorSrcNext, floorDestNext))
+    {
+        SkipArrival();
+        return -1;
+    }
+    int req;
+    if (listFreeSlots.empty())
+    {
+        req = store.Add(timeNext, floorSrcNext, floorDestNext);
+        listNextWaiting.push_back(-1);
+        listNextInCabin.push_back(-1);
+        listInWaitingChain.push_back(0);
+    }
+    else
+    {
+        req = listFreeSlots.back();
+        listFreeSlots.pop_back();
+        store.Set(req, timeNext, floorSrcNext, floorDestNext);
+    }
+    arrivalOrder.push_back(req);
+    ++arrivalCursor;
+    ++numTaken;
+    PullNext();
+    return req;
+}
+
+// Next request in time order is never collected
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::SkipArrival()
+{
+    if (pSource == nullptr)
+    {
+        ++arrivalCursor;
+        return;
+    }
+    pSink->Put(ECElevatorSimRequest(timeNext, floorSrcNext, floorDestNext));
+    ++numTaken;
+    PullNext();
+}
+
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::PullNext()
+{
+    fHasNext = pSource->GetNext(timeNext, floorSrcNext, floorDestNext);
+}
+
+// Streaming: request req is done; hand it over and reuse its index
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::ReleaseRequest(int req)
+{
+    pSink->Put(store.GetRequest(req));
+    listFreeSlots.push_back(req);
+}
+
+// Streaming: the waiting queue starting at req is drained; the requests still
+// chained there already got in, and the ones already serviced are now done
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::ReleaseWaitingChain(int req)
+{
+    if (pSource == nullptr)
+    {
+        return;
+    }
+    while (req >= 0)
+    {
+        int reqNext = listNextWaiting[req];
+        listInWaitingChain[req] = 0;
+        if (store.IsServiced(req))
+        {
+            ReleaseRequest(req);
+        }
+        req = reqNext;
+    }
+}
+
+// Passenger gets in: from now on the request is for its destination floor
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::BoardRequest(int req)
+{
+    SetFloorRequestDone(req);
+    store.SetBoardTime(req, timeElapsed);
+    stats.AddBoarded(timeElapsed - store.GetTime(req));
+    cabinToFloor[store.GetFloorDest(req)].Push(req, listNextInCabin);
+    carCalls.Set(store.GetFloorDest(req));
+    ++numInCabin;
+}
+
+// Request progress goes to the store, and to the request list if there is one
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::SetFloorRequestDone(int req)
+{
+    store.SetFloorRequestDone(req, true);
+    if (pListRequests != nullptr)
+    {
+        (*pListRequests)[req].SetFloorRequestDone(true);
+    }
+}
+
+// Passenger arrives now
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::SetServiced(int req)
+{
+    store.SetServiced(req, true);
+    store.SetArriveTime(req, timeElapsed);
+    if (pListRequests != nullptr)
+    {
+        (*pListRequests)[req].SetServiced(true);
+        (*pListRequests)[req].SetArriveTime(timeElapsed);
+    }
+}
+
+// Passenger starts waiting at its floor
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::PushWaiting(int req)
+{
+    int floor = store.GetFloorSrc(req);
+    if (store.IsGoingUp(req))
+    {
+        waitingUpAtFloor[floor].Push(req, listNextWaiting);
+        hallCallsUp.Set(floor);
+    }
+    else
+    {
+        waitingDownAtFloor[floor].Push(req, listNextWaiting);
+        hallCallsDown.Set(floor);
+    }
+    hallCalls.Set(floor);
+    ++numWaiting;
+    if (pSource != nullptr)
+    {
+        listInWaitingChain[req] = 1;
+    }
+}
+
+// A waiting passenger got in without the floor's queue being drained
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::DropWaiting(int req)
+{
+    int floor = store.GetFloorSrc(req);
+    bool fGoingUp = store.IsGoingUp(req);
+    ECFloorQueue &waiting = fGoingUp ? waitingUpAtFloor[floor] : waitingDownAtFloor[floor];
+    waiting.Drop();
+    if (waiting.IsEmpty())
+    {
+        // only requests that already got in are left in the queue
+        ReleaseWaitingChain(waiting.GetHead());
+        waiting.Clear();
+        (fGoingUp ? hallCallsUp : hallCallsDown).Reset(floor);
+        if (waitingUpAtFloor[floor].IsEmpty() && waitingDownAtFloor[floor].IsEmpty())
+        {
+            hallCalls.Reset(floor);
+        }
+    }
+    --numWaiting;
+}
+
+// Everyone waiting at the current floor to go up (down) gets in; returns true if anyone did
+template<class TPolicy, class TProfiler>
+bool ECElevatorSimT<TPolicy, TProfiler>::BoardWaiting(bool fGoingUp)
+{
+    ECFloorQueue &boarding = fGoingUp ? waitingUpAtFloor[currFloor] : waitingDownAtFloor[currFloor];
+    if (boarding.GetHead() < 0)
+    {
+        return false;
+    }
+
+    bool fBoarded = !boarding.IsEmpty();
+    numWaiting -= boarding.GetSize();
+    int req = boarding.GetHead();
+    boarding.Clear();
+    (fGoingUp ? hallCallsUp : hallCallsDown).Reset(currFloor);
+    if (waitingUpAtFloor[currFloor].IsEmpty() && waitingDownAtFloor[currFloor].IsEmpty())
+    {
+        hallCalls.Reset(currFloor);
+    }
+
+    // skip the ones that already got in
+    int reqHead = req;
+    while (req >= 0)
+    {
+        profiler.AddItems(EC_PHASE_HANDLE_PASSENGERS, 1);
+        int reqNext = listNextWaiting[req];
+        if (!store.IsFloorRequestDone(req))
+        {
+            BoardRequest(req);
+        }
+        req = reqNext;
     }
+    ReleaseWaitingChain(reqHead);
+    return fBoarded;
 }
 
-void ECElevatorSim::MoveOneFloor()
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::MoveOneFloor()
 {
+    typename TProfiler::Scope scope(profiler, EC_PHASE_MOVE_ONE_FLOOR);
+    profiler.AddItems(EC_PHASE_MOVE_ONE_FLOOR, 1);
+    lastDir = currDir;
     currFloor += (currDir == EC_ELEVATOR_UP) ? 1 : -1;
     ++timeElapsed;
 
@@ -102,115 +486,525 @@ void ECElevatorSim::MoveOneFloor()
     }
 }
 
-bool ECElevatorSim::HandlePassengers()
+template<class TPolicy, class TProfiler>
+bool ECElevatorSimT<TPolicy, TProfiler>::HandlePassengers()
 {
+    typename TProfiler::Scope scope(profiler, EC_PHASE_HANDLE_PASSENGERS);
     bool needToStop = false;
 
     // Handle passengers exiting
-    auto it = passengersInCabin.begin();
-    while (it != passengersInCabin.end())
+    ECFloorQueue &exiting = cabinToFloor[currFloor];
+    if (!exiting.IsEmpty())
     {
-        if ((*it)->GetFloorDest() == currFloor)
+        profiler.AddItems(EC_PHASE_HANDLE_PASSENGERS, exiting.GetSize());
+        for (int req = exiting.GetHead(); req >= 0; req = listNextInCabin[req])
         {
-            (*it)->SetServiced(true);
-            (*it)->SetArriveTime(timeElapsed);
-            it = passengersInCabin.erase(it);
-            needToStop = true;
+            SetServiced(req);
+            stats.AddServiced(store.GetBoardTime(req) - store.GetTime(req), timeElapsed - store.GetBoardTime(req));
+            if (pSource != nullptr && !listInWaitingChain[req])
+            {
+                ReleaseRequest(req);
+            }
         }
-        else
+        numInCabin -= exiting.GetSize();
+        exiting.Clear();
+        carCalls.Reset(currFloor);
+        needToStop = true;
+    }
+
+    // Handle new passengers boarding
+    if (!TPolicy::fDirectional)
+    {
+        needToStop = BoardWaiting(true) || needToStop;
+        needToStop = BoardWaiting(false) || needToStop;
+    }
+    else
+    {
+        // only the ones going our way, unless we turn around here
+        needToStop = BoardWaiting(currDir == EC_ELEVATOR_UP) || needToStop;
+        if (!TPolicy::KeepGoing(*this))
         {
-            ++it;
+            needToStop = BoardWaiting(currDir != EC_ELEVATOR_UP) || needToStop;
         }
     }
 
-    // Handle new passengers boarding
-    auto itReq = pendingRequests.begin();
-    while (itReq != pendingRequests.end())
+    return needToStop;
+}
+
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::DecideDirection()
+{
+    typename TProfiler::Scope scope(profiler, EC_PHASE_DECIDE_DIRECTION);
+    currDir = TPolicy::DecideDirection(*this);
+}
+
+template<class TPolicy, class TProfiler>
+bool ECElevatorSimT<TPolicy, TProfiler>::HasFurtherRequestsInCurrentDirection()
+{
+    typename TProfiler::Scope scope(profiler, EC_PHASE_HAS_FURTHER_REQUESTS);
+    return TPolicy::KeepGoing(*this);
+}
+
+// Floors to the nearest floor ahead (in the current direction) with a call. Nothing
+// happens on the floors before it (a policy may still pass this one by)
+template<class TPolicy, class TProfiler>
+int ECElevatorSimT<TPolicy, TProfiler>::GetDistanceToNextStop() const
+{
+    if (currDir == EC_ELEVATOR_UP)
     {
-        if (!(*itReq)->IsFloorRequestDone() && (*itReq)->GetFloorSrc() == currFloor)
+        int floor = hallCalls.FindAbove(currFloor, carCalls);
+        if (floor >= 0)
         {
-            (*itReq)->SetFloorRequestDone(true);
-            passengersInCabin.push_back(*itReq);
-            itReq = pendingRequests.erase(itReq);
-            needToStop = true;
+            return floor - currFloor;
         }
-        else
+    }
+    else if (currDir == EC_ELEVATOR_DOWN)
+    {
+        int floor = hallCalls.FindBelow(currFloor, carCalls);
+        if (floor >= 1)
         {
-            ++itReq;
+            return currFloor - floor;
         }
     }
-
-    return needToStop;
+    return numFloors + 1;
 }
 
-void ECElevatorSim::DecideDirection()
+template<class TPolicy, class TProfiler>
+int ECElevatorSimT<TPolicy, TProfiler>::GetFarthestCallAhead() const
 {
-    int nearestFloor = -1;
-    int minDistance = numFloors + 1;
-    EC_ELEVATOR_DIR dir = EC_ELEVATOR_STOPPED;
+    if (currDir == EC_ELEVATOR_UP)
+    {
+        int floor = hallCalls.FindBelow(numFloors + 1, carCalls);
+        return (floor > currFloor) ? floor : currFloor;
+    }
+    else if (currDir == EC_ELEVATOR_DOWN)
+    {
+        int floor = hallCalls.FindAbove(0, carCalls);
+        return (floor >= 1 && floor < currFloor) ? floor : currFloor;
+    }
+    return currFloor;
+}
 
-    for (auto *request : passengersInCabin)
+template<class TPolicy, class TProfiler>
+std::vector<int> ECElevatorSimT<TPolicy, TProfiler>::GetPassengerIndicesInCabin() const
+{
+    std::vector<int> listPassengers;
+    for (int floor = 1; floor <= numFloors; ++floor)
     {
-        int distance = abs(request->GetFloorDest() - currFloor);
-        if (distance < minDistance || (distance == minDistance && request->GetFloorDest() > currFloor))
+        for (int req = cabinToFloor[floor].GetHead(); req >= 0; req = listNextInCabin[req])
         {
-            nearestFloor = request->GetFloorDest();
-            minDistance = distance;
-            dir = (request->GetFloorDest() > currFloor) ? EC_ELEVATOR_UP : EC_ELEVATOR_DOWN;
+            listPassengers.push_back(req);
         }
     }
+    return listPassengers;
+}
 
-    // check pending requests
-    for (auto *request : pendingRequests)
+template<class TPolicy, class TProfiler>
+std::vector<int> ECElevatorSimT<TPolicy, TProfiler>::GetPendingRequestIndices() const
+{
+    std::vector<int> listPending;
+    for (int floor = 1; floor <= numFloors; ++floor)
     {
-        if (!request->IsFloorRequestDone())
+        for (const ECFloorQueue *waiting : {&waitingUpAtFloor[floor], &waitingDownAtFloor[floor]})
         {
-            int distance = abs(request->GetFloorSrc() - currFloor);
-            if (distance < minDistance || (distance == minDistance && request->GetFloorSrc() > currFloor))
+            for (int req = waiting->GetHead(); req >= 0; req = listNextWaiting[req])
             {
-                nearestFloor = request->GetFloorSrc();
-                minDistance = distance;
-                dir = (request->GetFloorSrc() > currFloor) ? EC_ELEVATOR_UP : EC_ELEVATOR_DOWN;
+                if (!store.IsFloorRequestDone(req))
+                {
+                    listPending.push_back(req);
+                }
             }
         }
     }
+    return listPending;
+}
+
+template<class TPolicy, class TProfiler>
+std::vector<ECElevatorSimRequest *> ECElevatorSimT<TPolicy, TProfiler>::GetPassengersInCabin() const
+{
+    std::vector<ECElevatorSimRequest *> listPassengers;
+    if (pListRequests != nullptr)
+    {
+        for (int req : GetPassengerIndicesInCabin())
+        {
+            listPassengers.push_back(&(*pListRequests)[req]);
+        }
+    }
+    return listPassengers;
+}
 
-    currDir = dir;
+template<class TPolicy, class TProfiler>
+std::vector<ECElevatorSimRequest *> ECElevatorSimT<TPolicy, TProfiler>::GetPendingRequests() const
+{
+    std::vector<ECElevatorSimRequest *> listPending;
+    if (pListRequests != nullptr)
+    {
+        for (int req : GetPendingRequestIndices())
+        {
+            listPending.push_back(&(*pListRequests)[req]);
+        }
+    }
+    return listPending;
 }
 
-bool ECElevatorSim::HasFurtherRequestsInCurrentDirection()
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::SaveSnapshot(std::vector<char> &buffer) const
 {
-    // check if any passengers in the caibn
-    for (auto *request : passengersInCabin)
+    size_t posBegin = buffer.size();
+    ECSnapshotWriter writer(buffer);
+    writer.Write(EC_SNAPSHOT_MAGIC);
+    writer.Write(EC_SNAPSHOT_VERSION);
+    writer.Write<uint64_t>(0); // total size, filled in at the end
+    writer.Write<int32_t>(numFloors);
+    writer.Write<uint8_t>(pSource != nullptr);
+    writer.Write<uint64_t>(store.GetSize());
+
+    writer.Write<int32_t>(timeElapsed);
+    writer.Write<int32_t>(currFloor);
+    writer.Write<int32_t>(currDir);
+    writer.Write<int32_t>(lastDir);
+    writer.Write<uint8_t>(fArrivalsInStoreOrder);
+    writer.WriteArray(arrivalOrder);
+    writer.Write<uint64_t>(arrivalCursor);
+    writer.Write<uint64_t>(arrivalTickBegin);
+    writer.Write<int32_t>(timeCollected);
+    writer.Write(numTaken);
+    store.Save(writer);
+    writer.WriteArray(listFreeSlots);
+    writer.WriteArray(listInWaitingChain);
+
+    writer.WriteArray(waitingUpAtFloor);
+    writer.WriteArray(waitingDownAtFloor);
+    writer.WriteArray(cabinToFloor);
+    writer.WriteArray(listNextWaiting);
+    writer.WriteArray(listNextInCabin);
+    writer.Write<int32_t>(numWaiting);
+    writer.Write<int32_t>(numInCabin);
+    hallCalls.Save(writer);
+    hallCallsUp.Save(writer);
+    hallCallsDown.Save(writer);
+    carCalls.Save(writer);
+    stats.Save(writer);
+
+    uint64_t sizeTotal = buffer.size() - posBegin;
+    memcpy(&buffer[posBegin + 2 * sizeof(uint32_t)], &sizeTotal, sizeof(sizeTotal));
+}
+
+template<class TPolicy, class TProfiler>
+bool ECElevatorSimT<TPolicy, TProfiler>::RestoreSnapshot(const char *data, size_t size)
+{
+    ECSnapshotReader reader(data, size);
+    uint32_t magic = 0, version = 0;
+    uint64_t sizeTotal = 0, numRequests = 0;
+    int32_t numFloorsSaved = 0;
+    uint8_t fStreaming = 0;
+    if (!reader.Read(magic) || !reader.Read(version) || !reader.Read(sizeTotal) || !reader.Read(numFloorsSaved) ||
+        !reader.Read(fStreaming) || !reader.Read(numRequests) ||
+        magic != EC_SNAPSHOT_MAGIC || version != EC_SNAPSHOT_VERSION || sizeTotal != size || numFloorsSaved != numFloors ||
+        (fStreaming != 0) != (pSource != nullptr) ||
+        (pSource == nullptr && numRequests != store.GetSize()))
+    {
+        return false;
+    }
+
+    // everything is read aside and checked first: a snapshot cut short, altered or
+    // inconsistent leaves this simulator as it was
+    int32_t timeElapsedSaved, currFloorSaved, currDirSaved, lastDirSaved, timeCollectedSaved;
+    int32_t numWaitingSaved, numInCabinSaved;
+    uint8_t fArrivalsInStoreOrderSaved;
+    uint64_t arrivalCursorSaved, arrivalTickBeginSaved;
+    long long numTakenSaved;
+    std::vector<int> arrivalOrderSaved, listFreeSlotsSaved, listNextWaitingSaved, listNextInCabinSaved;
+    std::vector<uint8_t> listInWaitingChainSaved;
+    std::vector<ECFloorQueue> waitingUpAtFloorSaved, waitingDownAtFloorSaved, cabinToFloorSaved;
+    ECElevatorRequestStore storeSaved;
+    ECFloorMask hallCallsSaved(hallCalls), hallCallsUpSaved(hallCallsUp), hallCallsDownSaved(hallCallsDown),
+        carCallsSaved(carCalls);
+    ECElevatorSimStats statsSaved;
+    bool fOK = reader.Read(timeElapsedSaved) && reader.Read(currFloorSaved) && reader.Read(currDirSaved) &&
+               reader.Read(lastDirSaved) && reader.Read(fArrivalsInStoreOrderSaved) && reader.ReadArray(arrivalOrderSaved) &&
+               reader.Read(arrivalCursorSaved) && reader.Read(arrivalTickBeginSaved) && reader.Read(timeCollectedSaved) &&
+               reader.Read(numTakenSaved) && storeSaved.Restore(reader) && reader.ReadArray(listFreeSlotsSaved) &&
+               reader.ReadArray(listInWaitingChainSaved) &&
+               reader.ReadArray(waitingUpAtFloorSaved) && reader.ReadArray(waitingDownAtFloorSaved) &&
+               reader.ReadArray(cabinToFloorSaved) &&
+               reader.ReadArray(listNextWaitingSaved) && reader.ReadArray(listNextInCabinSaved) &&
+               reader.Read(numWaitingSaved) && reader.Read(numInCabinSaved) &&
+               hallCallsSaved.Restore(reader) && hallCallsUpSaved.Restore(reader) && hallCallsDownSaved.Restore(reader) &&
+               carCallsSaved.Restore(reader) && statsSaved.Restore(reader) && reader.IsAtEnd();
+    if (!fOK)
+    {
+        return false;
+    }
+
+    // sizes and indices have to fit this building and the saved requests
+    size_t numRequestsSaved = storeSaved.GetSize();
+    size_t numArrivals = fArrivalsInStoreOrderSaved != 0 ? numRequestsSaved : arrivalOrderSaved.size();
+    size_t numFloorQueues = (size_t)numFloors + 1;
+    auto IsIndexList = [numRequestsSaved](const std::vector<int> &list, int indexMin)
+    {
+        for (int req : list)
+        {
+            if (req < indexMin || (req >= 0 && (size_t)req >= numRequestsSaved))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto AreQueuesValid = [numRequestsSaved, numFloorQueues](const std::vector<ECFloorQueue> &listQueues)
+    {
+        if (listQueues.size() != numFloorQueues)
+        {
+            return false;
+        }
+        for (const ECFloorQueue &queue : listQueues)
+        {
+            if (!queue.IsValid(numRequestsSaved))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    fOK = numRequestsSaved == numRequests && currFloorSaved >= 1 && currFloorSaved <= numFloors &&
+          currDirSaved >= EC_ELEVATOR_STOPPED && currDirSaved <= EC_ELEVATOR_DOWN &&
+          lastDirSaved >= EC_ELEVATOR_STOPPED && lastDirSaved <= EC_ELEVATOR_DOWN &&
+          arrivalTickBeginSaved <= arrivalCursorSaved && arrivalCursorSaved <= numArrivals &&
+          IsIndexList(arrivalOrderSaved, 0) && IsIndexList(listFreeSlotsSaved, 0) &&
+          listInWaitingChainSaved.size() == (pSource != nullptr ? numRequestsSaved : 0) &&
+          AreQueuesValid(waitingUpAtFloorSaved) && AreQueuesValid(waitingDownAtFloorSaved) &&
+          AreQueuesValid(cabinToFloorSaved) &&
+          listNextWaitingSaved.size() == numRequestsSaved && IsIndexList(listNextWaitingSaved, -1) &&
+          listNextInCabinSaved.size() == numRequestsSaved && IsIndexList(listNextInCabinSaved, -1) &&
+          numTakenSaved >= 0 && numWaitingSaved >= 0 && numInCabinSaved >= 0 && timeElapsedSaved >= 0 &&
+          timeCollectedSaved >= -1;
+    if (!fOK)
     {
-        int floor = request->GetFloorDest();
-        if ((currDir == EC_ELEVATOR_UP && floor > currFloor) ||
-            (currDir == EC_ELEVATOR_DOWN && floor < currFloor))
+        return false;
+    }
+
+    // arrivals: each request at most once; from the list they come in time order
+    std::vector<uint8_t> listSeen(numRequestsSaved, 0);
+    for (size_t i = 0; i < arrivalOrderSaved.size(); ++i)
+    {
+        int req = arrivalOrderSaved[i];
+        if (listSeen[req] ||
+            (pSource == nullptr && i > 0 && storeSaved.GetTime(req) < storeSaved.GetTime(arrivalOrderSaved[i - 1])))
         {
-            return true;
+            return false;
         }
+        listSeen[req] = 1;
+    }
+    if (fArrivalsInStoreOrderSaved != 0 && !arrivalOrderSaved.empty())
+    {
+        return false;
     }
 
-    // check all requests
-    for (auto *request : pendingRequests)
+    // Each queue is a chain through a next array that ends at its tail without coming
+    // back to a request (no cycle, and no request in two queues). Its requests are
+    // for its floor (and direction), and its count is the ones not picked up yet
+    // (every one, in the cabin). The totals and the call masks follow from the queues
+    std::vector<uint8_t> listInWaiting(numRequestsSaved, 0), listInCabin(numRequestsSaved, 0);
+    long long numWaitingQueued = 0, numInCabinQueued = 0;
+    auto IsChainValid = [&storeSaved](const ECFloorQueue &queue, const std::vector<int> &listNext,
+                                      std::vector<uint8_t> &listInQueue, bool fCabin, int floor, long long &numQueued)
     {
-        if (!request->IsFloorRequestDone())
+        int numLeft = 0;
+        int reqLast = -1;
+        for (int req = queue.GetHead(); req >= 0; req = listNext[req])
+        {
+            bool fPickedUp = storeSaved.IsFloorRequestDone(req);
+            if (listInQueue[req] || (fCabin ? storeSaved.GetFloorDest(req) : storeSaved.GetFloorSrc(req)) != floor ||
+                (fCabin && (!fPickedUp || storeSaved.IsServiced(req))) || (!fPickedUp && storeSaved.IsServiced(req)))
+            {
+                return false;
+            }
+            listInQueue[req] = 1;
+            numLeft += fPickedUp && !fCabin ? 0 : 1;
+            reqLast = req;
+        }
+        numQueued += queue.GetSize();
+        return reqLast == queue.GetTail() && numLeft == queue.GetSize() && (reqLast >= 0) == (numLeft > 0);
+    };
+    ECFloorMask hallCallsQueued(numFloors), hallCallsUpQueued(numFloors), hallCallsDownQueued(numFloors),
+        carCallsQueued(numFloors);
+    for (int floor = 0; floor <= numFloors; ++floor)
+    {
+        const ECFloorQueue &waitingUp = waitingUpAtFloorSaved[floor];
+        const ECFloorQueue &waitingDown = waitingDownAtFloorSaved[floor];
+        const ECFloorQueue &cabin = cabinToFloorSaved[floor];
+        if (!IsChainValid(waitingUp, listNextWaitingSaved, listInWaiting, false, floor, numWaitingQueued) ||
+            !IsChainValid(waitingDown, listNextWaitingSaved, listInWaiting, false, floor, numWaitingQueued) ||
+            !IsChainValid(cabin, listNextInCabinSaved, listInCabin, true, floor, numInCabinQueued))
+        {
+            return false;
+        }
+        for (int req = waitingUp.GetHead(); req >= 0; req = listNextWaitingSaved[req])
+        {
+            if (!storeSaved.IsGoingUp(req))
+            {
+                return false;
+            }
+        }
+        for (int req = waitingDown.GetHead(); req >= 0; req = listNextWaitingSaved[req])
         {
-            int floor = request->GetFloorSrc();
-            if ((currDir == EC_ELEVATOR_UP && floor > currFloor) ||
-                (currDir == EC_ELEVATOR_DOWN && floor < currFloor))
+            if (storeSaved.IsGoingUp(req))
             {
-                return true;
+                return false;
             }
         }
+        if (!waitingUp.IsEmpty())
+        {
+            hallCallsUpQueued.Set(floor);
+            hallCallsQueued.Set(floor);
+        }
+        if (!waitingDown.IsEmpty())
+        {
+            hallCallsDownQueued.Set(floor);
+            hallCallsQueued.Set(floor);
+        }
+        if (!cabin.IsEmpty())
+        {
+            carCallsQueued.Set(floor);
+        }
+    }
+    if (numWaitingQueued != numWaitingSaved || numInCabinQueued != numInCabinSaved ||
+        !(hallCallsQueued == hallCallsSaved) || !(hallCallsUpQueued == hallCallsUpSaved) ||
+        !(hallCallsDownQueued == hallCallsDownSaved) || !(carCallsQueued == carCallsSaved))
+    {
+        return false;
     }
 
-    return false;
+    // streaming: the chain flags match the waiting chains, and free indices are in no queue
+    if (pSource != nullptr)
+    {
+        if (listInWaitingChainSaved != listInWaiting)
+        {
+            return false;
+        }
+        std::fill(listSeen.begin(), listSeen.end(), 0);
+        for (int req : listFreeSlotsSaved)
+        {
+            if (listSeen[req] || listInWaiting[req] || listInCabin[req])
+            {
+                return false;
+            }
+            listSeen[req] = 1;
+        }
+    }
+
+    timeElapsed = timeElapsedSaved;
+    currFloor = currFloorSaved;
+    currDir = (EC_ELEVATOR_DIR)currDirSaved;
+    lastDir = (EC_ELEVATOR_DIR)lastDirSaved;
+    fArrivalsInStoreOrder = fArrivalsInStoreOrderSaved != 0;
+    arrivalOrder.swap(arrivalOrderSaved);
+    arrivalCursor = arrivalCursorSaved;
+    arrivalTickBegin = arrivalTickBeginSaved;
+    timeCollected = timeCollectedSaved;
+    numTaken = numTakenSaved;
+    store = std::move(storeSaved);
+    listFreeSlots.swap(listFreeSlotsSaved);
+    listInWaitingChain.swap(listInWaitingChainSaved);
+    waitingUpAtFloor.swap(waitingUpAtFloorSaved);
+    waitingDownAtFloor.swap(waitingDownAtFloorSaved);
+    cabinToFloor.swap(cabinToFloorSaved);
+    listNextWaiting.swap(listNextWaitingSaved);
+    listNextInCabin.swap(listNextInCabinSaved);
+    numWaiting = numWaitingSaved;
+    numInCabin = numInCabinSaved;
+    hallCalls = hallCallsSaved;
+    hallCallsUp = hallCallsUpSaved;
+    hallCallsDown = hallCallsDownSaved;
+    carCalls = carCallsSaved;
+    stats = statsSaved;
+
+    // the request list gets the saved progress
+    if (pListRequests != nullptr)
+    {
+        for (size_t i = 0; i < pListRequests->size(); ++i)
+        {
+            ECElevatorSimRequest &request = (*pListRequests)[i];
+            request.SetFloorRequestDone(store.IsFloorRequestDone((int)i));
+            request.SetServiced(store.IsServiced((int)i));
+            request.SetArriveTime(store.GetArriveTime((int)i));
+        }
+    }
+    return true;
 }
 
-void ECElevatorSim::MoveToFloor(int targetFloor)
+template<class TPolicy, class TProfiler>
+void ECElevatorSimT<TPolicy, TProfiler>::MoveToFloor(int targetFloor)
 {
+    targetFloor = max(1, min(targetFloor, numFloors));
+    while (currFloor != targetFloor)
+    {
+        CollectRequests(timeElapsed);
+        currDir = (targetFloor > currFloor) ? EC_ELEVATOR_UP : EC_ELEVATOR_DOWN;
+        MoveOneFloor();
+    }
+    currDir = EC_ELEVATOR_STOPPED;
+}
 
+// Shipped policies, with and without the phase profiler
+template class ECElevatorSimT<ECNearestCallPolicy>;
+template class ECElevatorSimT<ECLookPolicy>;
+template class ECElevatorSimT<ECScanPolicy>;
+template class ECElevatorSimT<ECCollectivePolicy>;
+template class ECElevatorSimT<ECNearestCallPolicy, ECPhaseProfiler>;
+template class ECElevatorSimT<ECLookPolicy, ECPhaseProfiler>;
+template class ECElevatorSimT<ECScanPolicy, ECPhaseProfiler>;
+template class ECElevatorSimT<ECCollectivePolicy, ECPhaseProfiler>;
+
+// Bit scans use the GCC/Clang builtins (std::countr_zero/countl_zero need C++20)
+int ECFloorMask::FindAbove(int floor, const ECFloorMask &maskOther) const
+{
+    int floorFrom = floor + 1;
+    if (floorFrom < 0)
+    {
+        floorFrom = 0;
+    }
+    size_t w = floorFrom >> 6;
+    if (w >= listWords.size())
+    {
+        return -1;
+    }
+    uint64_t bits = (listWords[w] | maskOther.listWords[w]) & (~uint64_t(0) << (floorFrom & 63));
+    while (bits == 0)
+    {
+        if (++w == listWords.size())
+        {
+            return -1;
+        }
+        bits = listWords[w] | maskOther.listWords[w];
+    }
+    return (int)(w << 6) + __builtin_ctzll(bits);
+}
+
+int ECFloorMask::FindBelow(int floor, const ECFloorMask &maskOther) const
+{
+    int floorFrom = floor - 1;
+    if (floorFrom < 0)
+    {
+        return -1;
+    }
+    size_t w = floorFrom >> 6;
+    if (w >= listWords.size())
+    {
+        w = listWords.size() - 1;
+        floorFrom = (int)(w << 6) + 63;
+    }
+    uint64_t bits = (listWords[w] | maskOther.listWords[w]) & (~uint64_t(0) >> (63 - (floorFrom & 63)));
+    while (bits == 0)
+    {
+        if (w-- == 0)
+        {
+            return -1;
+        }
+        bits = listWords[w] | maskOther.listWords[w];
+    }
+    return (int)(w << 6) + 63 - __builtin_clzll(bits);
 }
 
 int ECElevatorSimRequest::GetRequestedFloor() const
@@ -13,61 +13,12 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <cstdint>
+#include <climits>
 
-//*****************************************************************************
-// DON'T CHANGE THIS CLASS
-// 
-// Elevator simulation request: 
-// (i) time: when the request is made
-// (ii) floorSrc: which floor the user is at at present
-// (iii) floorDest floor: where the user wants to go; we assume floorDest != floorSrc
-// 
-// Note: a request is in three stages:
-// (i) floor request: the passenger is waiting at floorSrc; once the elevator arrived 
-// at the floor (and in the right direction), move to the next stage
-// (ii) inside request: passenger now requests to go to a specific floor once inside the elevator
-// (iii) Once the passenger arrives at the floor, this request is considered to be "serviced"
-//
-// two sspecial requests:
-// (a) maintenance start: floorSrc=floorDest=-1; put elevator into maintenance 
-// starting at the specified time; elevator starts at the current floor
-// (b) maintenance end: floorSrc=floorDest=0; put elevator back to operation (from the current floor)
-
-class ECElevatorSimRequest
-{
-public:
-    ECElevatorSimRequest(int timeIn, int floorSrcIn, int floorDestIn)
-        : time(timeIn), floorSrc(floorSrcIn), floorDest(floorDestIn),
-          fFloorReqDone(false), fServiced(false), timeArrive(-1) {}
-    int GetTime() const { return time; }
-    int GetFloorSrc() const { return floorSrc; }
-    int GetFloorDest() const { return floorDest; }
-    bool IsGoingUp() const { return floorDest >= floorSrc; }
-    bool IsFloorRequestDone() const { return fFloorReqDone; }
-    void SetFloorRequestDone(bool f) { fFloorReqDone = f; }
-    bool IsServiced() const { return fServiced; }
-    void SetServiced(bool f) { fServiced = f; }
-    int GetRequestedFloor() const;
-    int GetArriveTime() const { return timeArrive; }
-    void SetArriveTime(int t) { timeArrive = t; }
-
-private:
-    int time;           // time of request made
-    int floorSrc;       // which floor the request is made
-    int floorDest;      // which floor is going
-    bool fFloorReqDone;   // is this passenger passing stage one (no longer waiting at the floor) or not
-    bool fServiced;     // is this request serviced already?
-    int timeArrive;     // when the user gets to the desitnation floor
-};
-
-//*****************************************************************************
-// Elevator moving direction
-typedef enum
-{
-    EC_ELEVATOR_STOPPED = 0,    // not moving
-    EC_ELEVATOR_UP,             // moving up
-    EC_ELEVATOR_DOWN            // moving down
-} EC_ELEVATOR_DIR;
+// requests (ECElevatorSimRequest) and the moving direction (EC_ELEVATOR_DIR), shared
+// with the request store, request streams and scheduling policies
+#include "ECElevatorSimTypes.h"
 
 //*****************************************************************************
 // Add your own classes here...
@@ -81,6 +32,7 @@ public:
     virtual void Simulate(int lenSim) = 0;
     virtual void MoveToFloor(int targetFloor) = 0;
 
+    int GetNumFloors() const { return numFloors; }
     int GetCurrFloor() const { return currFloor; }
     void SetCurrFloor(int f) { currFloor = f; }
     EC_ELEVATOR_DIR GetCurrDir() const { return currDir; }
@@ -92,40 +44,356 @@ protected:
     EC_ELEVATOR_DIR currDir;
 };
 
+// compact request storage, request streams, time histograms, and the scheduling policies
+// and phase profilers the simulator below takes as template parameters
+#include "ECElevatorRequestStore.h"
+#include "ECElevatorRequestStream.h"
+#include "ECElevatorHistogram.h"
+#include "ECElevatorProfiler.h"
+#include "ECElevatorPolicy.h"
+
+//*****************************************************************************
+// FIFO of requests waiting at (or riding to) one floor. Requests are named by
+// their position in the request list and chained through a "next" array shared
+// by all floors, so queueing never allocates and draining a floor only visits
+// the requests queued there
+
+class ECFloorQueue
+{
+public:
+    ECFloorQueue() : head(-1), tail(-1), count(0) {}
+    bool IsEmpty() const { return count == 0; }
+    int GetSize() const { return count; }
+    int GetHead() const { return head; }
+    int GetTail() const { return tail; }
+    void Push(int req, std::vector<int> &listNext)
+    {
+        listNext[req] = -1;
+        if (tail < 0)
+        {
+            head = req;
+        }
+        else
+        {
+            listNext[tail] = req;
+        }
+        tail = req;
+        ++count;
+    }
+    // a request left the queue without being popped (it stays chained until Clear)
+    void Drop() { --count; }
+    void Clear() { head = tail = -1; count = 0; }
+    // ends are -1 or requests below numRequests (e.g. for a queue read from a snapshot)
+    bool IsValid(size_t numRequests) const
+    {
+        return head >= -1 && tail >= -1 && (size_t)(head + 1) <= numRequests && (size_t)(tail + 1) <= numRequests &&
+               count >= 0;
+    }
+
+private:
+    int head;
+    int tail;
+    int count;
+};
+
+//*****************************************************************************
+// One bit per floor (floor f is bit f). Finding the nearest marked floor above
+// or below a floor scans 64 floors per step
+
+class ECFloorMask
+{
+public:
+    ECFloorMask(int numFloors) : listWords(numFloors / 64 + 1, 0) {}
+    bool Test(int floor) const { return (listWords[floor >> 6] >> (floor & 63)) & 1; }
+    void Set(int floor) { listWords[floor >> 6] |= uint64_t(1) << (floor & 63); }
+    void Reset(int floor) { listWords[floor >> 6] &= ~(uint64_t(1) << (floor & 63)); }
+    bool operator==(const ECFloorMask &other) const { return listWords == other.listWords; }
+
+    // nearest floor strictly above/below floor marked in this mask or in maskOther; -1 if none
+    int FindAbove(int floor, const ECFloorMask &maskOther) const;
+    int FindBelow(int floor, const ECFloorMask &maskOther) const;
+
+    void Save(ECSnapshotWriter &writer) const { writer.WriteArray(listWords); }
+    bool Restore(ECSnapshotReader &reader)
+    {
+        size_t numWords = listWords.size();
+        return reader.ReadArray(listWords) && listWords.size() == numWords;
+    }
+
+private:
+    std::vector<uint64_t> listWords;
+};
+
+//*****************************************************************************
+// Running totals over requests (made, picked up, arrived): wait is from the request until the elevator
+// picks the passenger up, ride from then until the passenger arrives, and trip is both. Each passenger's
+// times go into histograms when the passenger arrives
+
+class ECElevatorSimStats
+{
+public:
+    ECElevatorSimStats() : numRequests(0), numBoarded(0), numServiced(0), timeWaitTotal(0), timeTripTotal(0) {}
+    void AddRequest() { ++numRequests; }
+    void AddBoarded(int timeWait)
+    {
+        ++numBoarded;
+        timeWaitTotal += timeWait;
+    }
+    void AddServiced(int timeWait, int timeRide)
+    {
+        ++numServiced;
+        timeTripTotal += timeWait + timeRide;
+        histWait.Record(timeWait);
+        histRide.Record(timeRide);
+        histTrip.Record(timeWait + timeRide);
+    }
+    void Merge(const ECElevatorSimStats &other)
+    {
+        numRequests += other.numRequests;
+        numBoarded += other.numBoarded;
+        numServiced += other.numServiced;
+        timeWaitTotal += other.timeWaitTotal;
+        timeTripTotal += other.timeTripTotal;
+        histWait.Merge(other.histWait);
+        histRide.Merge(other.histRide);
+        histTrip.Merge(other.histTrip);
+    }
+    long long GetNumRequests() const { return numRequests; }
+    long long GetNumBoarded() const { return numBoarded; }
+    long long GetNumServiced() const { return numServiced; }
+    double GetAverageWaitTime() const { return numBoarded > 0 ? (double)timeWaitTotal / numBoarded : 0.0; }
+    double GetAverageTripTime() const { return numServiced > 0 ? (double)timeTripTotal / numServiced : 0.0; }
+
+    // Times of the passengers who arrived
+    const ECLatencyHistogram &GetWaitHistogram() const { return histWait; }
+    const ECLatencyHistogram &GetRideHistogram() const { return histRide; }
+    const ECLatencyHistogram &GetTripHistogram() const { return histTrip; }
+    // One line each for wait, ride and trip times: count, mean, p50, p90, p99, p99.9, max
+    void Print(std::ostream &os) const
+    {
+        os << "        count      mean     p50     p90     p99   p99.9     max\n";
+        os << "Wait";
+        histWait.Print(os);
+        os << "\nRide";
+        histRide.Print(os);
+        os << "\nTrip";
+        histTrip.Print(os);
+        os << "\n";
+    }
+
+    void Save(ECSnapshotWriter &writer) const
+    {
+        writer.Write(numRequests);
+        writer.Write(numBoarded);
+        writer.Write(numServiced);
+        writer.Write(timeWaitTotal);
+        writer.Write(timeTripTotal);
+        histWait.Save(writer);
+        histRide.Save(writer);
+        histTrip.Save(writer);
+    }
+    bool Restore(ECSnapshotReader &reader)
+    {
+        return reader.Read(numRequests) && reader.Read(numBoarded) && reader.Read(numServiced) &&
+               reader.Read(timeWaitTotal) && reader.Read(timeTripTotal) &&
+               histWait.Restore(reader) && histRide.Restore(reader) && histTrip.Restore(reader);
+    }
+
+private:
+    long long numRequests;
+    long long numBoarded;
+    long long numServiced;
+    long long timeWaitTotal;
+    long long timeTripTotal;
+    ECLatencyHistogram histWait;
+    ECLatencyHistogram histRide;
+    ECLatencyHistogram histTrip;
+};
+
 //*****************************************************************************
 // Simulation of elevator
+// TPolicy decides where the elevator goes (see ECElevatorPolicy.h); TProfiler
+// measures the phases of the loop (see ECElevatorProfiler.h; off by default). The
+// shipped policies are instantiated in ECElevatorSim.cpp, with either profiler
 
-class ECElevatorSim : public ElevatorBase
+template<class TPolicy = ECNearestCallPolicy, class TProfiler = ECNoProfiler>
+class ECElevatorSimT : public ElevatorBase
 {
 public:
-    ECElevatorSim(int numFloors, std::vector<ECElevatorSimRequest> &listRequests);
-    ~ECElevatorSim();
+    // fAllRequests=false: start with no requests; they are handed over one by one
+    // (in time order) with AssignRequest, e.g. by a dispatcher.
+    // The requests are copied into a request store; progress (floor request done,
+    // serviced, arrive time) is written back to listRequests as it happens
+    ECElevatorSimT(int numFloors, std::vector<ECElevatorSimRequest> &listRequests, bool fAllRequests = true);
+    // Simulate the requests of store in place (nothing is copied). Progress is
+    // also written back to *pListRequests if given (same requests, same order)
+    ECElevatorSimT(int numFloors, ECElevatorRequestStore &store, bool fAllRequests = true,
+                   std::vector<ECElevatorSimRequest> *pListRequests = nullptr);
+    // Streaming: requests are pulled from source (in time order) as simulated time
+    // reaches them, and handed to sink once serviced (or found never to be), then
+    // forgotten. Only the requests in flight are kept in memory
+    ECElevatorSimT(int numFloors, ECRequestSource &source, ECRequestSink &sink);
+    ~ECElevatorSimT();
 
+    // Simulate (and RunUntil, Step) go on from where the previous call stopped, up to
+    // time lenSim; the elevator may end one time unit later when it stops at a floor then
     void Simulate(int lenSim) override;
+    void RunUntil(int timeEnd) { Simulate(timeEnd); }
+    void Step(int numTimeUnits = 1) { Simulate(timeElapsed + numTimeUnits); }
+    // Take the elevator to targetFloor regardless of the policy, one floor per time unit,
+    // stopping on the way where passengers get in or out; then the policy takes over again
     void MoveToFloor(int targetFloor) override;
-    const std::vector<ECElevatorSimRequest *> &GetPassengersInCabin() const {
-        return passengersInCabin;
-    }
 
-    const std::vector<ECElevatorSimRequest *> &GetPendingRequests() const {
-        return pendingRequests;
-    }
+    // Next-event mode: jump over idle time and over floors where nothing can happen
+    // (arrival times are the same as the tick-by-tick engine); off by default
+    void SetTimeSkipping(bool f) { fTimeSkipping = f; }
+    bool IsTimeSkipping() const { return fTimeSkipping; }
+
+    // Checkpoint of the whole simulation state (time, position, queues, requests
+    // and stats) appended to buffer; see ECElevatorSnapshot.h for the format
+    void SaveSnapshot(std::vector<char> &buffer) const;
+    // Continue from a snapshot (e.g. read back from a file, or mapped in memory).
+    // This simulator must have been made the same way as the saved one: same number
+    // of floors and requests (the request list gets the saved progress) or both
+    // streaming; the policy may differ. When streaming, the source must start right
+    // after the first GetNumRequestsTaken() requests of the saved simulator's source.
+    // Returns false if data is not such a snapshot (including one cut short, altered or
+    // inconsistent with this building, or whose queues, totals and calls disagree);
+    // then the state is unchanged
+    bool RestoreSnapshot(const char *data, size_t size);
+    // Streaming: requests taken from the source so far (not counting the one read ahead)
+    long long GetNumRequestsTaken() const { return numTaken; }
+
+    // Snapshots of the queues (built on demand), as request indices (when streaming,
+    // indices into GetRequestStore() that are reused once a request is done)
+    std::vector<int> GetPassengerIndicesInCabin() const;
+    std::vector<int> GetPendingRequestIndices() const;
+    // Same, as pointers into the request list (empty if there is none)
+    std::vector<ECElevatorSimRequest *> GetPassengersInCabin() const;
+    std::vector<ECElevatorSimRequest *> GetPendingRequests() const;
+    int GetNumPassengersInCabin() const { return numInCabin; }
+    int GetNumPendingRequests() const { return numWaiting; }
+
+    // Give this elevator request req; it must not be earlier than any request
+    // assigned before, nor earlier than the time already simulated
+    void AssignRequest(int req) { arrivalOrder.push_back(req); }
+    // Requests given to this elevator and not collected yet (made later than the time simulated)
+    int GetNumRequestsToCome() const { return (int)(GetNumArrivals() - arrivalCursor); }
+    const ECElevatorRequestStore &GetRequestStore() const { return store; }
+
+    int GetTimeElapsed() const { return timeElapsed; }
+    // Time of the next request not collected yet (INT_MAX if none)
+    int GetNextRequestTime() const { return GetNextArrivalTime(); }
+    // No one waiting or riding, and no requests to come
+    bool IsFinished() const { return numWaiting == 0 && numInCabin == 0 && GetNextArrivalTime() == INT_MAX; }
+    const ECElevatorSimStats &GetStats() const { return stats; }
+    ECElevatorSimStats &GetStats() { return stats; }
+    // Calls, items and cycles per phase so far (print with GetProfiler().Print(os))
+    const TProfiler &GetProfiler() const { return profiler; }
+    TProfiler &GetProfiler() { return profiler; }
+    // Direction of the last move (stays set while stopped; STOPPED if never moved)
+    EC_ELEVATOR_DIR GetLastDir() const { return lastDir; }
+
+    // Calls: floors where someone waits (hall calls, by direction) or someone in the cabin goes (car calls)
+    bool HasCallAt(int floor) const { return floor >= 1 && floor <= numFloors && (hallCalls.Test(floor) || carCalls.Test(floor)); }
+    bool HasHallCallAt(int floor) const { return floor >= 1 && floor <= numFloors && hallCalls.Test(floor); }
+    bool HasHallCallUpAt(int floor) const { return floor >= 1 && floor <= numFloors && hallCallsUp.Test(floor); }
+    bool HasHallCallDownAt(int floor) const { return floor >= 1 && floor <= numFloors && hallCallsDown.Test(floor); }
+    bool HasCarCallAt(int floor) const { return floor >= 1 && floor <= numFloors && carCalls.Test(floor); }
+    // Nearest floor with a call strictly above/below floor (-1 if none)
+    int FindCallAbove(int floor) const { return hallCalls.FindAbove(floor, carCalls); }
+    int FindCallBelow(int floor) const { int f = hallCalls.FindBelow(floor, carCalls); return f >= 1 ? f : -1; }
+    // Farthest floor with a call in the current direction (current floor if none)
+    int GetFarthestCallAhead() const;
 
 private:
     // Your code here
     int timeElapsed;
-    std::vector<ECElevatorSimRequest *> pendingRequests;
-    std::vector<ECElevatorSimRequest> &listRequests;
+    bool fTimeSkipping;
+    EC_ELEVATOR_DIR lastDir;
+
+    // Requests, by index. The engine reads and writes the store; listRequests (if
+    // any) only receives the progress of each request
+    ECElevatorRequestStore storeOwned;
+    ECElevatorRequestStore &store;
+    std::vector<ECElevatorSimRequest> *pListRequests;
+
+    // Streaming (pSource not null): the next request of the source, not taken yet.
+    // Store indices of finished requests are reused; a request that got in while still
+    // chained in a waiting queue (see below) is only finished once it is unchained
+    ECRequestSource *pSource;
+    ECRequestSink *pSink;
+    bool fHasNext;
+    int timeNext;
+    int floorSrcNext;
+    int floorDestNext;
+    long long numTaken;
+    std::vector<int> listFreeSlots;
+    std::vector<uint8_t> listInWaitingChain;
+
+    // Arrival index: request indices sorted by request time (not built if the store
+    // is already sorted: then position i is request i; when streaming, it only holds
+    // the requests that arrived at timeCollected).
+    // Requests before arrivalCursor have already been collected; the ones in
+    // [arrivalTickBegin, arrivalCursor) arrived at timeCollected
+    bool fArrivalsInStoreOrder;
+    std::vector<int> arrivalOrder;
+    size_t arrivalCursor;
+    size_t arrivalTickBegin;
+    int timeCollected;
 
-    // New member variables
-    std::vector<ECElevatorSimRequest *> passengersInCabin;
+    // Per-floor queues: passengers waiting at floor f (going up / down) and passengers
+    // in the cabin going to floor f. Requests boarded straight from the arrival index
+    // are dropped from their waiting queue lazily (skipped when the floor is drained)
+    std::vector<ECFloorQueue> waitingUpAtFloor;
+    std::vector<ECFloorQueue> waitingDownAtFloor;
+    std::vector<ECFloorQueue> cabinToFloor;
+    std::vector<int> listNextWaiting;
+    std::vector<int> listNextInCabin;
+    int numWaiting;
+    int numInCabin;
+
+    // Floors with someone waiting (hall calls: any direction, up, down) and floors
+    // someone in the cabin is going to (car calls); kept in sync with the queues above
+    ECFloorMask hallCalls;
+    ECFloorMask hallCallsUp;
+    ECFloorMask hallCallsDown;
+    ECFloorMask carCalls;
+
+    ECElevatorSimStats stats;
+    TProfiler profiler;
 
     // New member functions
+    void InitArrivals(bool fAllRequests);
+    size_t GetNumArrivals() const { return fArrivalsInStoreOrder ? store.GetSize() : arrivalOrder.size(); }
+    int GetArrival(size_t pos) const { return fArrivalsInStoreOrder ? (int)pos : arrivalOrder[pos]; }
+    bool IsValidRequest(int floorSrc, int floorDest) const;
+    int TakeArrival();
+    void SkipArrival();
+    void PullNext();
+    void ReleaseRequest(int req);
+    void ReleaseWaitingChain(int req);
+    void SetFloorRequestDone(int req);
+    void SetServiced(int req);
     void CollectRequests(int currentTime);
+    void BoardRequest(int req);
+    void PushWaiting(int req);
+    void DropWaiting(int req);
+    bool BoardWaiting(bool fGoingUp);
     void MoveOneFloor();
+    bool SkipFloors(int lenSim);
+    void SkipIdle(int lenSim);
+    int GetNextArrivalTime() const;
+    int GetDistanceToNextStop() const;
     void DecideDirection();
     bool HasFurtherRequestsInCurrentDirection();
     bool HandlePassengers();
 };
 
-#endif /* ECElevatorSim_h */
\ No newline at end of file
+typedef ECElevatorSimT<ECNearestCallPolicy> ECElevatorSim;
+typedef ECElevatorSimT<ECLookPolicy> ECElevatorSimLook;
+typedef ECElevatorSimT<ECScanPolicy> ECElevatorSimScan;
+typedef ECElevatorSimT<ECCollectivePolicy> ECElevatorSimCollective;
+typedef ECElevatorSimT<ECNearestCallPolicy, ECPhaseProfiler> ECElevatorSimProfiled;
+
+#endif /* ECElevatorSim_h */
@@ -0,0 +1,66 @@
+//
+//  ECElevatorSimTypes.h
+//
+//
+//  Types shared by the simulator and the parts it is built from (request store,
+//  request streams, scheduling policies)
+
+#ifndef ECElevatorSimTypes_h
+#define ECElevatorSimTypes_h
+
+//*****************************************************************************
+// DON'T CHANGE THIS CLASS
+// 
+// Elevator simulation request: 
+// (i) time: when the request is made
+// (ii) floorSrc: which floor the user is at at present
+// (iii) floorDest floor: where the user wants to go; we assume floorDest != floorSrc
+// 
+// Note: a request is in three stages:
+// (i) floor request: the passenger is waiting at floorSrc; once the elevator arrived 
+// at the floor (and in the right direction), move to the next stage
+// (ii) inside request: passenger now requests to go to a specific floor once inside the elevator
+// (iii) Once the passenger arrives at the floor, this request is considered to be "serviced"
+//
+// two sspecial requests:
+// (a) maintenance start: floorSrc=floorDest=-1; put elevator into maintenance 
+// starting at the specified time; elevator starts at the current floor
+// (b) maintenance end: floorSrc=floorDest=0; put elevator back to operation (from the current floor)
+
+class ECElevatorSimRequest
+{
+public:
+    ECElevatorSimRequest(int timeIn, int floorSrcIn, int floorDestIn)
+        : time(timeIn), floorSrc(floorSrcIn), floorDest(floorDestIn),
+          fFloorReqDone(false), fServiced(false), timeArrive(-1) {}
+    int GetTime() const { return time; }
+    int GetFloorSrc() const { return floorSrc; }
+    int GetFloorDest() const { return floorDest; }
+    bool IsGoingUp() const { return floorDest >= floorSrc; }
+    bool IsFloorRequestDone() const { return fFloorReqDone; }
+    void SetFloorRequestDone(bool f) { fFloorReqDone = f; }
+    bool IsServiced() const { return fServiced; }
+    void SetServiced(bool f) { fServiced = f; }
+    int GetRequestedFloor() const;
+    int GetArriveTime() const { return timeArrive; }
+    void SetArriveTime(int t) { timeArrive = t; }
+
+private:
+    int time;           // time of request made
+    int floorSrc;       // which floor the request is made
+    int floorDest;      // which floor is going
+    bool fFloorReqDone;   // is this passenger passing stage one (no longer waiting at the floor) or not
+    bool fServiced;     // is this request serviced already?
+    int timeArrive;     // when the user gets to the desitnation floor
+};
+
+//*****************************************************************************
+// Elevator moving direction
+typedef enum
+{
+    EC_ELEVATOR_STOPPED = 0,    // not moving
+    EC_ELEVATOR_UP,             // moving up
+    EC_ELEVATOR_DOWN            // moving down
+} EC_ELEVATOR_DIR;
+
+#endif /* ECElevatorSimTypes_h */
@@ -0,0 +1,96 @@
+//
+//  ECElevatorSnapshot.h
+//
+//
+//  Binary snapshots of simulation state
+
+#ifndef ECElevatorSnapshot_h
+#define ECElevatorSnapshot_h
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+//*****************************************************************************
+// Snapshot layout: a header (magic "ECSS", format version, total size in bytes),
+// then plain values and arrays (element count, then the elements' bytes) in the
+// order the simulator writes them. Values are stored as they are in memory, so a
+// snapshot is read back on the same kind of machine; arrays are restored with one
+// memcpy each
+
+const uint32_t EC_SNAPSHOT_MAGIC = 0x53534345; // "ECSS"
+const uint32_t EC_SNAPSHOT_VERSION = 2;
+
+class ECSnapshotWriter
+{
+public:
+    explicit ECSnapshotWriter(std::vector<char> &buffer) : buffer(buffer) {}
+    template<class T>
+    void Write(const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied bytewise");
+        WriteBytes(&value, sizeof(T));
+    }
+    template<class T>
+    void WriteArray(const std::vector<T> &list)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied bytewise");
+        Write<uint64_t>(list.size());
+        WriteBytes(list.data(), list.size() * sizeof(T));
+    }
+    void WriteBytes(const void *data, size_t size)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+private:
+    std::vector<char> &buffer;
+};
+
+// Every read fails (returns false) instead of going past the end of the data
+class ECSnapshotReader
+{
+public:
+    ECSnapshotReader(const char *data, size_t size) : data(data), size(size), pos(0) {}
+    template<class T>
+    bool Read(T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied bytewise");
+        return ReadBytes(&value, sizeof(T));
+    }
+    template<class T>
+    bool ReadArray(std::vector<T> &list)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied bytewise");
+        uint64_t num;
+        if (!Read(num) || num > (size - pos) / sizeof(T))
+        {
+            return false;
+        }
+        list.resize(num);
+        return ReadBytes(list.data(), num * sizeof(T));
+    }
+    bool ReadBytes(void *dest, size_t num)
+    {
+        if (num > size - pos)
+        {
+            return false;
+        }
+        if (num > 0)
+        {
+            memcpy(dest, data + pos, num);
+        }
+        pos += num;
+        return true;
+    }
+    bool IsAtEnd() const { return pos == size; }
+
+private:
+    const char *data;
+    size_t size;
+    size_t pos;
+};
+
+#endif /* ECElevatorSnapshot_h */
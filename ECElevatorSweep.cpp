@@ -0,0 +1,409 @@
+//
+//  ECElevatorSweep.cpp
+//
+//
+//  Parameter sweeps: floors x arrival rate x policy x number of cars
+
+#include "ECElevatorSweep.h"
+#include "ECElevatorBank.h"
+#include "ECElevatorWorkload.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+//*****************************************************************************
+// Work-stealing pool
+
+ECWorkStealingPool::ECWorkStealingPool(int numThreads) : numThreads(numThreads)
+{
+    if (this->numThreads <= 0)
+    {
+        this->numThreads = max(1u, thread::hardware_concurrency());
+    }
+}
+
+void ECWorkStealingPool::Run(const std::vector<std::function<void()>> &listJobs)
+{
+    int numWorkers = min(numThreads, max((int)listJobs.size(), 1));
+    vector<ECJobQueue> listQueues(numWorkers);
+    for (size_t i = 0; i < listJobs.size(); ++i)
+    {
+        listQueues[i % numWorkers].listJobs.push_back(&listJobs[i]);
+    }
+
+    // no job is added while running: once every queue is empty, a thread is done
+    vector<thread> listThreads;
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        listThreads.emplace_back([this, &listQueues, i]() {
+            for (const function<void()> *job = TakeJob(listQueues, i); job != nullptr; job = TakeJob(listQueues, i))
+            {
+                (*job)();
+            }
+        });
+    }
+    for (auto &t : listThreads)
+    {
+        t.join();
+    }
+}
+
+const std::function<void()> *ECWorkStealingPool::TakeJob(std::vector<ECJobQueue> &listQueues, int i)
+{
+    {
+        lock_guard<mutex> guard(listQueues[i].lock);
+        if (!listQueues[i].listJobs.empty())
+        {
+            const function<void()> *job = listQueues[i].listJobs.front();
+            listQueues[i].listJobs.pop_front();
+            return job;
+        }
+    }
+    for (size_t k = 1; k < listQueues.size(); ++k)
+    {
+        ECJobQueue &victim = listQueues[(i + k) % listQueues.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.listJobs.empty())
+        {
+            const function<void()> *job = victim.listJobs.back();
+            victim.listJobs.pop_back();
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+//*****************************************************************************
+// Spec
+
+template<class T>
+static bool ReadValues(std::istringstream &iss, std::vector<T> &listValues)
+{
+    listValues.clear();
+    T value;
+    while (iss >> value)
+    {
+        listValues.push_back(value);
+    }
+    return !listValues.empty() && iss.eof();
+}
+
+bool ECSweepSpec::Parse(std::istream &is, std::string &strError)
+{
+    string line;
+    int numLine = 0;
+    while (getline(is, line))
+    {
+        ++numLine;
+        size_t posComment = line.find('#');
+        if (posComment != string::npos)
+        {
+            line.erase(posComment);
+        }
+        size_t posEq = line.find('=');
+        if (posEq == string::npos)
+        {
+            if (line.find_first_not_of(" \t\r") != string::npos)
+            {
+                strError = "line " + to_string(numLine) + ": expected key = values";
+                return false;
+            }
+            continue;
+        }
+
+        string key;
+        istringstream(line.substr(0, posEq)) >> key;
+        istringstream iss(line.substr(posEq + 1));
+        bool fOK = true;
+        vector<long long> listInts;
+        if (key == "floors")
+        {
+            fOK = ReadValues(iss, listFloors);
+        }
+        else if (key == "rate")
+        {
+            fOK = ReadValues(iss, listRates);
+        }
+        else if (key == "policy")
+        {
+            fOK = ReadValues(iss, listPolicies);
+        }
+        else if (key == "cars")
+        {
+            fOK = ReadValues(iss, listCars);
+        }
+        else if (key == "runs" || key == "time" || key == "drain" || key == "seed" || key == "threads")
+        {
+            fOK = ReadValues(iss, listInts) && listInts.size() == 1;
+            if (fOK)
+            {
+                long long value = listInts[0];
+                if (key == "runs") numRuns = (int)value;
+                else if (key == "time") timeArrivals = (int)value;
+                else if (key == "drain") timeDrain = (int)value;
+                else if (key == "seed") seed = (uint64_t)value;
+                else numThreads = (int)value;
+            }
+        }
+        else
+        {
+            strError = "line " + to_string(numLine) + ": unknown key " + key;
+            return false;
+        }
+        if (!fOK)
+        {
+            strError = "line " + to_string(numLine) + ": bad values for " + key;
+            return false;
+        }
+    }
+
+    if (listFloors.empty() || listRates.empty() || listPolicies.empty() || listCars.empty())
+    {
+        strError = "floors, rate, policy and cars are required";
+        return false;
+    }
+    for (int numFloors : listFloors)
+    {
+        if (numFloors < 2)
+        {
+            strError = "floors must be at least 2";
+            return false;
+        }
+    }
+    for (double rate : listRates)
+    {
+        if (!(rate > 0.0))
+        {
+            strError = "rate must be positive";
+            return false;
+        }
+    }
+    for (const string &policy : listPolicies)
+    {
+        if (!ECElevatorSweep::IsPolicyName(policy))
+        {
+            strError = "unknown policy " + policy;
+            return false;
+        }
+    }
+    for (int numCars : listCars)
+    {
+        if (numCars < 1)
+        {
+            strError = "cars must be at least 1";
+            return false;
+        }
+    }
+    if (numRuns < 1 || timeArrivals < 1 || timeDrain < 0)
+    {
+        strError = "runs and time must be positive, drain not negative";
+        return false;
+    }
+    return true;
+}
+
+std::string ECSweepCell::GetKey() const
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%d,%g,%s,%d", numFloors, rate, policy.c_str(), numCars);
+    return buf;
+}
+
+//*****************************************************************************
+// Sweep driver
+
+ECElevatorSweep::ECElevatorSweep(const ECSweepSpec &spec, const std::string &fileResults)
+    : spec(spec), fileResults(fileResults)
+{
+    for (int numFloors : spec.listFloors)
+    {
+        for (double rate : spec.listRates)
+        {
+            for (const string &policy : spec.listPolicies)
+            {
+                for (int numCars : spec.listCars)
+                {
+                    listCells.push_back({numFloors, rate, policy, numCars});
+                }
+            }
+        }
+    }
+}
+
+bool ECElevatorSweep::IsPolicyName(const std::string &policy)
+{
+    return policy == "nearest" || policy == "look" || policy == "scan" || policy == "collective";
+}
+
+std::string ECElevatorSweep::GetHeader()
+{
+    return "floors,rate,policy,cars,runs,requests,serviced,"
+           "wait_mean,wait_p50,wait_p90,wait_p99,wait_max,"
+           "trip_mean,trip_p50,trip_p90,trip_p99,trip_max,wall_s";
+}
+
+// Keys of the complete rows in the results file
+void ECElevatorSweep::ReadFinishedCells(std::vector<std::string> &listKeys) const
+{
+    ifstream infile(fileResults);
+    string line;
+    const string header = GetHeader();
+    size_t numColumns = count(header.begin(), header.end(), ',');
+    while (getline(infile, line))
+    {
+        // a row cut short by an interruption doesn't count
+        if (infile.eof() || (size_t)count(line.begin(), line.end(), ',') != numColumns || line == header)
+        {
+            continue;
+        }
+        size_t pos = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            pos = line.find(',', pos) + 1;
+        }
+        listKeys.push_back(line.substr(0, pos - 1));
+    }
+}
+
+template<class TPolicy>
+static void RunCellSims(const ECMonteCarloConfig &config, int numCars, ECElevatorSimStats &stats)
+{
+    for (int run = 0; run < config.numRuns; ++run)
+    {
+        vector<ECElevatorSimRequest> listRequests;
+        config.MakeRequests(run, listRequests);
+        ECElevatorBankT<TPolicy> bank(config.numFloors, numCars, listRequests);
+        bank.SetTimeSkipping(true);
+        bank.Simulate(config.GetTimeSim());
+        stats.Merge(bank.GetStats());
+    }
+}
+
+ECMonteCarloReport ECElevatorSweep::RunCell(const ECSweepCell &cell) const
+{
+    auto timeStart = chrono::steady_clock::now();
+
+    ECMonteCarloConfig config;
+    config.numFloors = cell.numFloors;
+    config.timeArrivals = spec.timeArrivals;
+    config.timeDrain = spec.timeDrain;
+    config.numRuns = spec.numRuns;
+    // seed from floors and rate only (FNV-1a): every policy and car count sees the
+    // same workloads, in whatever grid the cell is
+    char bufWorkload[64];
+    snprintf(bufWorkload, sizeof(bufWorkload), "%d,%g", cell.numFloors, cell.rate);
+    config.seed = 14695981039346656037ULL;
+    for (const char *p = bufWorkload; *p != '\0'; ++p)
+    {
+        config.seed = (config.seed ^ (unsigned char)*p) * 1099511628211ULL;
+    }
+    config.seed ^= spec.seed;
+    double rate = cell.rate;
+    config.workload = [rate](const ECMonteCarloConfig &config, uint64_t seed, std::vector<ECElevatorSimRequest> &listRequests) {
+        // Poisson arrivals: exponential gaps between requests, uniform floors
+        ECRandom rng(seed);
+        for (double time = rng.NextExponential(rate); time < config.timeArrivals && config.numFloors > 1;
+             time += rng.NextExponential(rate))
+        {
+            int floorSrc = 1 + rng.NextInt(config.numFloors);
+            // any other floor
+            int floorDest = 1 + rng.NextInt(config.numFloors - 1);
+            if (floorDest >= floorSrc)
+            {
+                ++floorDest;
+            }
+            listRequests.push_back(ECElevatorSimRequest((int)time, floorSrc, floorDest));
+        }
+    };
+
+    ECElevatorSimStats stats;
+    if (cell.policy == "look")
+    {
+        RunCellSims<ECLookPolicy>(config, cell.numCars, stats);
+    }
+    else if (cell.policy == "scan")
+    {
+        RunCellSims<ECScanPolicy>(config, cell.numCars, stats);
+    }
+    else if (cell.policy == "collective")
+    {
+        RunCellSims<ECCollectivePolicy>(config, cell.numCars, stats);
+    }
+    else
+    {
+        RunCellSims<ECNearestCallPolicy>(config, cell.numCars, stats);
+    }
+
+    chrono::duration<double> timeWall = chrono::steady_clock::now() - timeStart;
+    return ECMonteCarloReport(config.numRuns, stats, timeWall.count());
+}
+
+int ECElevatorSweep::Run()
+{
+    vector<string> listDone;
+    ReadFinishedCells(listDone);
+    sort(listDone.begin(), listDone.end());
+
+    // new file, or an interrupted one whose last row was cut short (not ended by a newline)
+    bool fNewFile = true, fEndsLine = true;
+    {
+        ifstream infile(fileResults, ios::binary | ios::ate);
+        if (infile.good() && infile.tellg() > 0)
+        {
+            fNewFile = false;
+            infile.seekg(-1, ios::end);
+            fEndsLine = (infile.get() == '\n');
+        }
+    }
+    ofstream outfile(fileResults, ios::app);
+    if (!outfile.is_open())
+    {
+        cerr << "Error: Could not open the file: " << fileResults << endl;
+        return -1;
+    }
+    if (fNewFile)
+    {
+        outfile << GetHeader() << endl;
+    }
+    else if (!fEndsLine)
+    {
+        outfile << endl;
+    }
+
+    // biggest cells first, so the long ones don't end up last
+    vector<int> listTodo;
+    for (size_t i = 0; i < listCells.size(); ++i)
+    {
+        if (!binary_search(listDone.begin(), listDone.end(), listCells[i].GetKey()))
+        {
+            listTodo.push_back((int)i);
+        }
+    }
+    auto cost = [this](int i) { return (double)listCells[i].numFloors * listCells[i].rate / listCells[i].numCars; };
+    stable_sort(listTodo.begin(), listTodo.end(), [&cost](int a, int b) { return cost(a) > cost(b); });
+
+    mutex lockOutput;
+    vector<function<void()>> listJobs;
+    for (int i : listTodo)
+    {
+        listJobs.push_back([this, i, &outfile, &lockOutput]() {
+            ECMonteCarloReport report = RunCell(listCells[i]);
+            const ECTimeSummary &wait = report.GetWaitTime(), &trip = report.GetTripTime();
+            char buf[512];
+            snprintf(buf, sizeof(buf), "%s,%d,%lld,%lld,%.3f,%d,%d,%d,%d,%.3f,%d,%d,%d,%d,%.3f",
+                     listCells[i].GetKey().c_str(), report.GetNumRuns(), report.GetNumRequests(), report.GetNumServiced(),
+                     wait.mean, wait.p50, wait.p90, wait.p99, wait.max,
+                     trip.mean, trip.p50, trip.p90, trip.p99, trip.max, report.GetWallTime());
+            lock_guard<mutex> guard(lockOutput);
+            outfile << buf << endl;
+        });
+    }
+    ECWorkStealingPool pool(spec.numThreads);
+    pool.Run(listJobs);
+    return (int)listJobs.size();
+}
@@ -0,0 +1,111 @@
+//
+//  ECElevatorSweep.h
+//
+//
+//  Parameter sweeps: floors x arrival rate x policy x number of cars
+
+#ifndef ECElevatorSweep_h
+#define ECElevatorSweep_h
+
+#include "ECElevatorMonteCarlo.h"
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Thread pool with work stealing: jobs are dealt round-robin to per-thread queues.
+// A thread takes jobs from the front of its own queue (in the order given, e.g.
+// longest first); once that is empty it steals from the back of another thread's
+// queue, so threads stay busy even when some jobs take much longer than others
+
+class ECWorkStealingPool
+{
+public:
+    ECWorkStealingPool(int numThreads);   // 0: one per core
+
+    int GetNumThreads() const { return numThreads; }
+    void Run(const std::vector<std::function<void()>> &listJobs);
+
+private:
+    struct ECJobQueue
+    {
+        std::mutex lock;
+        std::deque<const std::function<void()> *> listJobs;
+    };
+    const std::function<void()> *TakeJob(std::vector<ECJobQueue> &listQueues, int i);
+
+    int numThreads;
+};
+
+//*****************************************************************************
+// Grid of a sweep; every combination of the lists is one cell. Read from a text
+// spec, one "key = values..." per line (# starts a comment), e.g.
+//   floors = 5 20 100
+//   rate = 0.02 0.1        (requests per time unit, Poisson arrivals)
+//   policy = nearest look scan collective
+//   cars = 1 2 4
+//   runs = 10              (randomized runs per cell)
+//   time = 10000           (requests are made in [0, time))
+//   drain = 2000           (extra time simulated after that)
+//   seed = 1
+//   threads = 0            (0: one per core)
+
+struct ECSweepSpec
+{
+    std::vector<int> listFloors;
+    std::vector<double> listRates;
+    std::vector<std::string> listPolicies;
+    std::vector<int> listCars;
+    int numRuns = 10;
+    int timeArrivals = 10000;
+    int timeDrain = 2000;
+    uint64_t seed = 1;
+    int numThreads = 0;
+
+    // returns false (with a message in strError) if the spec is not valid
+    bool Parse(std::istream &is, std::string &strError);
+};
+
+struct ECSweepCell
+{
+    int numFloors;
+    double rate;
+    std::string policy;
+    int numCars;
+
+    // first columns of the cell's result row
+    std::string GetKey() const;
+};
+
+//*****************************************************************************
+// Sweep driver: expands the spec into cells and runs them on a work-stealing pool;
+// each cell runs spec.numRuns simulations of an ECElevatorBankT with its policy.
+// Every finished cell appends one CSV row to the results file right away. Cells
+// that already have a row in the file are skipped, so an interrupted sweep picks
+// up where it stopped
+
+class ECElevatorSweep
+{
+public:
+    ECElevatorSweep(const ECSweepSpec &spec, const std::string &fileResults);
+
+    const std::vector<ECSweepCell> &GetCells() const { return listCells; }
+    // Run the cells not in the results file yet; returns how many were run (-1: can't write the file)
+    int Run();
+
+    static bool IsPolicyName(const std::string &policy);
+    static std::string GetHeader();
+
+private:
+    ECMonteCarloReport RunCell(const ECSweepCell &cell) const;
+    void ReadFinishedCells(std::vector<std::string> &listKeys) const;
+
+    ECSweepSpec spec;
+    std::string fileResults;
+    std::vector<ECSweepCell> listCells;
+};
+
+#endif /* ECElevatorSweep_h */
@@ -3,6 +3,21 @@
 #include <vector>
 #include <iostream>
 #include "ECElevatorSim.h"
+#include "ECElevatorBank.h"
+#include "ECElevatorMonteCarlo.h"
+#include "ECElevatorSweep.h"
+#include "ECElevatorBenchmark.h"
+#include "ECElevatorWorkload.h"
+#include "ECElevatorTrace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 using namespace std;
 
@@ -20,10 +35,11 @@ void ASSERT_EQ(T x, T y)
   }
 }
 
-static void RunTest(int numFloors, int timeSim, vector<ECElevatorSimRequest> &listRequests, vector<int> &listArriveTime )
+static void RunTest(int numFloors, int timeSim, vector<ECElevatorSimRequest> &listRequests, vector<int> &listArriveTime, bool fTimeSkipping )
 {
     // simulate
     ECElevatorSim sim(numFloors, listRequests );
+    sim.SetTimeSkipping(fTimeSkipping);
     sim.Simulate(timeSim);
 
     // status of requests
@@ -46,6 +62,38 @@ static void RunTest(int numFloors, int timeSim, vector<ECElevatorSimRequest> &li
     }
 }
 
+template<class TSim>
+static void RunPolicyTest(int numFloors, int timeSim, vector<ECElevatorSimRequest> listRequests, const vector<int> &listArriveTime )
+{
+    TSim sim(numFloors, listRequests );
+    sim.Simulate(timeSim);
+
+    for(unsigned int i=0; i<listRequests.size(); ++i)
+    {
+        ASSERT_EQ(listRequests[i].GetArriveTime(), listArriveTime[i] );
+    }
+}
+
+static void RunBankTest(int numFloors, int numCars, int timeSim, vector<ECElevatorSimRequest> &listRequests, vector<int> &listArriveTime )
+{
+    ECElevatorBank bank(numFloors, numCars, listRequests);
+    bank.Simulate(timeSim);
+
+    for(unsigned int i=0; i<listRequests.size(); ++i)
+    {
+        ASSERT_EQ(listRequests[i].GetArriveTime(), listArriveTime[i] );
+    }
+}
+
+// run the same case with the tick-by-tick engine, the next-event engine and a one-car bank
+static void RunTest(int numFloors, int timeSim, vector<ECElevatorSimRequest> &listRequests, vector<int> &listArriveTime )
+{
+    vector<ECElevatorSimRequest> listRequestsCopy(listRequests), listRequestsBank(listRequests);
+    RunTest(numFloors, timeSim, listRequests, listArriveTime, false);
+    RunTest(numFloors, timeSim, listRequestsCopy, listArriveTime, true);
+    RunBankTest(numFloors, 1, timeSim, listRequestsBank, listArriveTime);
+}
+
 // a simple test: a single passenger going from floor 3 to 1
 // this passenger arrived time 7: 
 // (i) elevator gets to floor 3 at time 4 (received request from this passenger at time 2);
@@ -172,6 +220,719 @@ static void Test4()
     RunTest(NUM_FLOORS, timeSim, listRequests, listArriveTime);
 }
 
+// Long idle stretches and long trips: the next-event engine skips over them
+// passenger 1: elevator gets to floor 9 at time 508, in at 509, arrives floor 2 at time 516
+// passenger 2: elevator waits at floor 2, gets to floor 1 at time 901, in at 902, arrives floor 20 at time 921
+static void Test5()
+{
+    cout << "\n****** TEST 5\n";
+    // test setup
+    const int NUM_FLOORS = 20;
+    const int timeSim = 1000;
+    ECElevatorSimRequest r1(500, 9, 2), r2(900, 1, 20);
+    vector<ECElevatorSimRequest> listRequests;
+    listRequests.push_back(r1);
+    listRequests.push_back(r2);
+    vector<int> listArriveTime;
+    listArriveTime.push_back(516);
+    listArriveTime.push_back(921);
+
+    // simulate
+    RunTest(NUM_FLOORS, timeSim, listRequests, listArriveTime);
+}
+
+// Bank of two cars, two passengers
+// With one car: it goes up to floor 8 for passenger 1 (in at time 9) and comes back down to
+// floor 1 at time 17 (passenger 1 arrives), where passenger 2 has been waiting since time 4;
+// passenger 2 arrives at floor 5 at time 22
+// With two cars: car 1 takes passenger 1 (same times); car 2 is idle at floor 1 when
+// passenger 2 shows up, so passenger 2 gets in right away and arrives at time 8
+static void Test6()
+{
+    cout << "\n****** TEST 6\n";
+    // test setup
+    const int NUM_FLOORS = 10;
+    const int timeSim = 30;
+    ECElevatorSimRequest r1(2, 8, 1), r2(4, 1, 5);
+    vector<ECElevatorSimRequest> listRequests;
+    listRequests.push_back(r1);
+    listRequests.push_back(r2);
+    vector<ECElevatorSimRequest> listRequests2(listRequests);
+    vector<int> listArriveTime;
+    listArriveTime.push_back(17);
+    listArriveTime.push_back(22);
+    vector<int> listArriveTime2;
+    listArriveTime2.push_back(17);
+    listArriveTime2.push_back(8);
+
+    // simulate
+    RunBankTest(NUM_FLOORS, 1, timeSim, listRequests, listArriveTime);
+    RunBankTest(NUM_FLOORS, 2, timeSim, listRequests2, listArriveTime2);
+}
+
+// Dispatch policies, two passengers: passenger 1 at floor 6 going down to 2 (time 0),
+// passenger 2 at floor 4 going up to 9 (time 1)
+// Nearest call and LOOK: pick up passenger 2 at floor 4 (time 3) and passenger 1 at floor 6
+// (time 6), drop passenger 2 at floor 9 (time 10), then go down to floor 2 (time 18)
+// SCAN: same, but goes on up to floor 10 (time 12) before turning around: floor 2 at time 20
+// Collective control: passes floor 6 going up (passenger 1 goes down), so passenger 2 arrives
+// at time 9; turns around and picks up passenger 1 at time 13, floor 2 at time 18
+static void Test7()
+{
+    cout << "\n****** TEST 7\n";
+    // test setup
+    const int NUM_FLOORS = 10;
+    const int timeSim = 30;
+    ECElevatorSimRequest r1(0, 6, 2), r2(1, 4, 9);
+    vector<ECElevatorSimRequest> listRequests;
+    listRequests.push_back(r1);
+    listRequests.push_back(r2);
+
+    // simulate
+    RunPolicyTest<ECElevatorSim>(NUM_FLOORS, timeSim, listRequests, {18, 10});
+    RunPolicyTest<ECElevatorSimLook>(NUM_FLOORS, timeSim, listRequests, {18, 10});
+    RunPolicyTest<ECElevatorSimScan>(NUM_FLOORS, timeSim, listRequests, {20, 10});
+    RunPolicyTest<ECElevatorSimCollective>(NUM_FLOORS, timeSim, listRequests, {18, 9});
+}
+
+// Monte Carlo batch: every run has its own seed, so the merged report is the same
+// whether the batch runs on one thread or on four
+static void Test8()
+{
+    cout << "\n****** TEST 8\n";
+    ECMonteCarloConfig config;
+    config.numFloors = 12;
+    config.numRequests = 200;
+    config.numRuns = 40;
+    config.numThreads = 1;
+    ECMonteCarloReport report1 = ECRunMonteCarlo<ECElevatorSim>(config);
+    config.numThreads = 4;
+    ECMonteCarloReport report4 = ECRunMonteCarlo<ECElevatorSim>(config);
+
+    ASSERT_EQ(report1.GetNumServiced(), report4.GetNumServiced());
+    ASSERT_EQ(report1.GetWaitTime().mean, report4.GetWaitTime().mean);
+    ASSERT_EQ(report1.GetWaitTime().p99, report4.GetWaitTime().p99);
+    ASSERT_EQ(report1.GetTripTime().p90, report4.GetTripTime().p90);
+    ASSERT_EQ(report1.GetTripTime().max, report4.GetTripTime().max);
+}
+
+// Sweep: 2 x 1 x 2 x 2 = 8 cells, one row each; running again finds them all done
+static void Test9()
+{
+    cout << "\n****** TEST 9\n";
+    const char *fileResults = "ECElevatorTest_sweep.csv";
+    remove(fileResults);
+
+    ECSweepSpec spec;
+    string strError;
+    istringstream iss("floors = 5 10\nrate = 0.05\npolicy = nearest look\ncars = 1 2\nruns = 2\ntime = 500\n");
+    ASSERT_EQ(spec.Parse(iss, strError), true);
+
+    ECElevatorSweep sweep(spec, fileResults);
+    ASSERT_EQ(sweep.Run(), 8);
+    ECElevatorSweep sweepAgain(spec, fileResults);
+    ASSERT_EQ(sweepAgain.Run(), 0);
+    remove(fileResults);
+}
+
+// Request store: the requests of test 7, simulated straight from the store, in time
+// order and out of order (then the engine sorts them); same arrival times as test 7
+static void Test10()
+{
+    cout << "\n****** TEST 10\n";
+    const int NUM_FLOORS = 10;
+    const int timeSim = 30;
+    ECElevatorRequestStore store;
+    store.Add(0, 6, 2);
+    store.Add(1, 4, 9);
+    ASSERT_EQ(store.IsSortedByTime(), true);
+    ECElevatorSim sim(NUM_FLOORS, store);
+    sim.SetTimeSkipping(true);
+    sim.Simulate(timeSim);
+    ASSERT_EQ(store.GetArriveTime(0), 18);
+    ASSERT_EQ(store.GetArriveTime(1), 10);
+
+    ECElevatorRequestStore storeReversed;
+    storeReversed.Add(1, 4, 9);
+    storeReversed.Add(0, 6, 2);
+    ASSERT_EQ(storeReversed.IsSortedByTime(), false);
+    ECElevatorBank bank(NUM_FLOORS, 1, storeReversed);
+    bank.Simulate(timeSim);
+    ASSERT_EQ(storeReversed.GetArriveTime(0), 10);
+    ASSERT_EQ(storeReversed.GetArriveTime(1), 18);
+}
+
+// Streaming: the requests of test 7 read from a request file and written out as
+// they arrive: passenger 2 first (time 10), then passenger 1 (time 18)
+static void Test11()
+{
+    cout << "\n****** TEST 11\n";
+    istringstream iss("# test 7\n10 30\n0 6 2\n1 4 9\n");
+    ostringstream oss;
+    ECRequestReader reader(iss);
+    ECRequestWriter writer(oss);
+    ASSERT_EQ(reader.GetNumFloors(), 10);
+    ECElevatorSim sim(reader.GetNumFloors(), reader, writer);
+    sim.Simulate(reader.GetTimeSim());
+    ASSERT_EQ(oss.str(), string("1 4 9 10\n0 6 2 18\n"));
+}
+
+// Snapshot: the requests of test 7 simulated up to time 5 and saved; a new simulator
+// restored from the snapshot finishes with the same arrival times as test 7
+static void Test12()
+{
+    cout << "\n****** TEST 12\n";
+    const int NUM_FLOORS = 10;
+    const int timeSim = 30;
+    ECElevatorSimRequest r1(0, 6, 2), r2(1, 4, 9);
+    vector<ECElevatorSimRequest> listRequests;
+    listRequests.push_back(r1);
+    listRequests.push_back(r2);
+    vector<ECElevatorSimRequest> listRequestsRestored(listRequests);
+
+    ECElevatorSim sim(NUM_FLOORS, listRequests);
+    sim.Simulate(5);
+    vector<char> snapshot;
+    sim.SaveSnapshot(snapshot);
+
+    ECElevatorSim simRestored(NUM_FLOORS, listRequestsRestored);
+    ASSERT_EQ(simRestored.RestoreSnapshot(snapshot.data(), snapshot.size()), true);
+    ASSERT_EQ(simRestored.GetTimeElapsed(), 5);
+    ASSERT_EQ(listRequestsRestored[1].IsFloorRequestDone(), true);
+    simRestored.Simulate(timeSim);
+    ASSERT_EQ(listRequestsRestored[0].GetArriveTime(), 18);
+    ASSERT_EQ(listRequestsRestored[1].GetArriveTime(), 10);
+
+    // not a snapshot of a 10-floor building
+    ECElevatorSim simOther(NUM_FLOORS + 1, listRequestsRestored);
+    ASSERT_EQ(simOther.RestoreSnapshot(snapshot.data(), snapshot.size()), false);
+}
+
+// Incremental runs: the requests of test 7 one time unit at a time give the same
+// arrival times. Then MoveToFloor: a passenger waits at floor 3 to go to 8; the
+// elevator is sent to floor 5, picks the passenger up on the way (time 2, gets
+// going at time 3) and is at floor 5 at time 5; the policy then takes the
+// passenger to floor 8 (time 8)
+static void Test13()
+{
+    cout << "\n****** TEST 13\n";
+    const int NUM_FLOORS = 10;
+    ECElevatorSimRequest r1(0, 6, 2), r2(1, 4, 9);
+    vector<ECElevatorSimRequest> listRequests;
+    listRequests.push_back(r1);
+    listRequests.push_back(r2);
+    ECElevatorSim sim(NUM_FLOORS, listRequests);
+    while (!sim.IsFinished())
+    {
+        sim.Step();
+    }
+    ASSERT_EQ(listRequests[0].GetArriveTime(), 18);
+    ASSERT_EQ(listRequests[1].GetArriveTime(), 10);
+
+    ECElevatorSimRequest r3(0, 3, 8);
+    vector<ECElevatorSimRequest> listRequests2;
+    listRequests2.push_back(r3);
+    ECElevatorSim sim2(NUM_FLOORS, listRequests2);
+    sim2.MoveToFloor(5);
+    ASSERT_EQ(sim2.GetCurrFloor(), 5);
+    ASSERT_EQ(sim2.GetTimeElapsed(), 5);
+    ASSERT_EQ(sim2.GetNumPassengersInCabin(), 1);
+    sim2.RunUntil(20);
+    ASSERT_EQ(listRequests2[0].GetArriveTime(), 8);
+    ASSERT_EQ(sim2.IsFinished(), true);
+}
+
+// Histograms: in test 7 (nearest call) passenger 1 waits 6 and rides 12 (trip 18),
+// passenger 2 waits 2 and rides 7 (trip 9). Small times are exact; large ones are
+// within about 3%, merged histograms add up
+static void Test14()
+{
+    cout << "\n****** TEST 14\n";
+    ECElevatorSimRequest r1(0, 6, 2), r2(1, 4, 9);
+    vector<ECElevatorSimRequest> listRequests;
+    listRequests.push_back(r1);
+    listRequests.push_back(r2);
+    ECElevatorSim sim(10, listRequests);
+    sim.Simulate(30);
+    const ECElevatorSimStats &stats = sim.GetStats();
+    ASSERT_EQ(stats.GetWaitHistogram().GetPercentile(50), 2);
+    ASSERT_EQ(stats.GetWaitHistogram().GetMax(), 6);
+    ASSERT_EQ(stats.GetRideHistogram().GetPercentile(50), 7);
+    ASSERT_EQ(stats.GetRideHistogram().GetPercentile(99.9), 12);
+    ASSERT_EQ(stats.GetTripHistogram().GetPercentile(99), 18);
+    ASSERT_EQ(stats.GetTripHistogram().GetMean(), 13.5);
+
+    ECLatencyHistogram hist1, hist2;
+    for (int t = 1; t <= 1000; ++t)
+    {
+        hist1.Record(1000 * t);
+    }
+    hist2.Record(5);
+    hist1.Merge(hist2);
+    ASSERT_EQ(hist1.GetCount(), 1001LL);
+    ASSERT_EQ(hist1.GetPercentile(0), 5);
+    int p50 = hist1.GetPercentile(50);
+    ASSERT_EQ(p50 >= 500000 && p50 <= 516000, true);
+    ASSERT_EQ(hist1.GetMax(), 1000000);
+}
+
+// Profiled simulator: same arrival times as test 7; the elevator goes from floor 1
+// up to 9 and down to 2 (15 moves), collecting requests at least once per move
+static void Test15()
+{
+    cout << "\n****** TEST 15\n";
+    ECElevatorSimRequest r1(0, 6, 2), r2(1, 4, 9);
+    vector<ECElevatorSimRequest> listRequests;
+    listRequests.push_back(r1);
+    listRequests.push_back(r2);
+    ECElevatorSimProfiled sim(10, listRequests);
+    sim.Simulate(30);
+    ASSERT_EQ(listRequests[0].GetArriveTime(), 18);
+    ASSERT_EQ(listRequests[1].GetArriveTime(), 10);
+    const ECPhaseProfiler &profiler = sim.GetProfiler();
+    ASSERT_EQ(profiler.GetNumCalls(EC_PHASE_MOVE_ONE_FLOOR), 15LL);
+    ASSERT_EQ(profiler.GetNumCalls(EC_PHASE_HANDLE_PASSENGERS), 15LL);
+    ASSERT_EQ(profiler.GetNumItems(EC_PHASE_COLLECT_REQUESTS) >= 2, true);
+    ASSERT_EQ(profiler.GetNumCalls(EC_PHASE_COLLECT_REQUESTS) >= 15, true);
+    sim.GetProfiler().Print(cout);
+}
+
+// Benchmark: every passenger of a small up-peak workload arrives; a baseline
+// written and read back flags a case 20% slower than it with a 10% threshold
+static void Test16()
+{
+    cout << "\n****** TEST 16\n";
+    ECBenchmarkCase bcase = {EC_TRAFFIC_UP_PEAK, 20, 500, true};
+    ECBenchmarkResult result = ECRunBenchmarkCase(bcase, 1);
+    ASSERT_EQ(result.numServiced, 500LL);
+    ASSERT_EQ(result.bcase.GetKey(), string("uppeak,20,500,skip"));
+
+    stringstream ss;
+    ECWriteBenchmarkBaseline(ss, {result});
+    map<string, double> baseline;
+    ASSERT_EQ(ECReadBenchmarkBaseline(ss, baseline), true);
+    ASSERT_EQ(baseline.count(bcase.GetKey()), (size_t)1);
+    ostringstream oss;
+    ASSERT_EQ(ECPrintBenchmarkComparison(oss, {result}, baseline, 10.0), 0);
+    result.nsPerRequest = baseline[bcase.GetKey()] * 1.2;
+    ASSERT_EQ(ECPrintBenchmarkComparison(oss, {result}, baseline, 10.0), 1);
+}
+
+// Workload generator: exactly the requested number of valid requests, in time
+// order within the day; the same seed gives the same requests, floors without
+// people are never used, and most up-peak requests start in the lobby. A request
+// file written from it reads back the same
+static void Test17()
+{
+    cout << "\n****** TEST 17\n";
+    ECWorkloadGenerator gen1(10, 2000, 3600, EC_PROFILE_DAY, 5), gen2(10, 2000, 3600, EC_PROFILE_DAY, 5);
+    gen1.SetFloorWeights({2, 1, 0});
+    gen2.SetFloorWeights({2, 1, 0});
+    ostringstream oss;
+    {
+        ECRequestFileWriter writer(oss, 10, 3600);
+        int time1, src1, dest1, time2, src2, dest2, timePrev = 0;
+        bool fSame = true, fOrdered = true, fValid = true, fFloor3 = false;
+        while (gen1.GetNext(time1, src1, dest1))
+        {
+            gen2.GetNext(time2, src2, dest2);
+            fSame = fSame && time1 == time2 && src1 == src2 && dest1 == dest2;
+            fOrdered = fOrdered && time1 >= timePrev && time1 < 3600;
+            fValid = fValid && src1 != dest1 && src1 >= 1 && src1 <= 10 && dest1 >= 1 && dest1 <= 10;
+            fFloor3 = fFloor3 || src1 == 3 || dest1 == 3;
+            timePrev = time1;
+            writer.Write(time1, src1, dest1);
+        }
+        ASSERT_EQ(gen1.GetNumGenerated(), 2000LL);
+        ASSERT_EQ(fSame, true);
+        ASSERT_EQ(fOrdered, true);
+        ASSERT_EQ(fValid, true);
+        ASSERT_EQ(fFloor3, false);
+    }
+
+    istringstream iss(oss.str());
+    ECRequestReader reader(iss);
+    ASSERT_EQ(reader.GetNumFloors(), 10);
+    ASSERT_EQ(reader.GetTimeSim(), 3600);
+    ECWorkloadGenerator gen3(10, 2000, 3600, EC_PROFILE_DAY, 5);
+    gen3.SetFloorWeights({2, 1, 0});
+    int numRead = 0, time1, src1, dest1, time2, src2, dest2;
+    bool fSame = true;
+    while (reader.GetNext(time1, src1, dest1))
+    {
+        gen3.GetNext(time2, src2, dest2);
+        fSame = fSame && time1 == time2 && src1 == src2 && dest1 == dest2;
+        ++numRead;
+    }
+    ASSERT_EQ(numRead, 2000);
+    ASSERT_EQ(fSame, true);
+
+    ECWorkloadGenerator genUp(10, 2000, 3600, EC_PROFILE_UP_PEAK, 5), genOther(10, 2000, 3600, EC_PROFILE_UP_PEAK, 6);
+    int numLobby = 0, numDiff = 0;
+    while (genUp.GetNext(time1, src1, dest1) && genOther.GetNext(time2, src2, dest2))
+    {
+        numLobby += src1 == 1;
+        numDiff += time1 != time2 || src1 != src2 || dest1 != dest2;
+    }
+    ASSERT_EQ(numLobby > 1600, true);
+    ASSERT_EQ(numDiff > 1000, true);
+}
+
+// Binary trace: a request file converted to a trace is sorted by time (requests
+// at the same time keep their order), maps back with its header, simulates like
+// the request list, and converts back to text; a file that is not a trace is refused
+static void Test18()
+{
+    cout << "\n****** TEST 18\n";
+    const char *fileTrace = "ECElevatorTest_trace.ectr";
+    istringstream iss("# three requests\n10 30\n4 6 2\n0 1 5\n4 3 9\n");
+    string strError;
+    ASSERT_EQ(ECConvertTextTrace(iss, fileTrace, strError), true);
+
+    {
+        ECTraceFile trace;
+        ASSERT_EQ(trace.Open(fileTrace, strError), true);
+        ASSERT_EQ(trace.GetNumFloors(), 10);
+        ASSERT_EQ(trace.GetTimeSim(), 30);
+        ASSERT_EQ(trace.GetNumRequests(), (size_t)3);
+        ASSERT_EQ(trace.begin()[0].GetTime(), 0);
+        ASSERT_EQ(trace.begin()[1].GetFloorSrc(), 6);
+        ASSERT_EQ(trace.begin()[2].GetFloorDest(), 9);
+
+        vector<ECElevatorSimRequest> listRequests = {ECElevatorSimRequest(0, 1, 5), ECElevatorSimRequest(4, 6, 2),
+                                                     ECElevatorSimRequest(4, 3, 9)};
+        ECElevatorSim simList(10, listRequests);
+        simList.Simulate(30);
+        ECTraceRequestSource source(trace.begin(), trace.end());
+        ostringstream ossServiced;
+        ECRequestWriter sink(ossServiced);
+        ECElevatorSim simTrace(10, source, sink);
+        simTrace.Simulate(30);
+        ASSERT_EQ(simTrace.GetStats().GetNumServiced(), simList.GetStats().GetNumServiced());
+        ASSERT_EQ(simTrace.GetStats().GetTripHistogram().GetMean(), simList.GetStats().GetTripHistogram().GetMean());
+    }
+
+    ostringstream oss;
+    ASSERT_EQ(ECConvertBinaryTrace(fileTrace, oss, strError), true);
+    ASSERT_EQ(oss.str(), string("10 30\n0 1 5\n4 6 2\n4 3 9\n"));
+    remove(fileTrace);
+
+    {
+        ofstream outfile(fileTrace, ios::binary);
+        outfile << "# a request file, not a trace\n10 30\n0 1 5\n4 6 2\n4 3 9\n";
+    }
+    ECTraceFile trace;
+    ASSERT_EQ(trace.Open(fileTrace, strError), false);
+    ASSERT_EQ(strError, string("not a trace file"));
+    remove(fileTrace);
+}
+
+// Loading a request file: comments, blank lines and Windows line ends are
+// skipped, the header is returned, requests come out in time order (same-time
+// requests in file order) on any number of threads; bad lines are reported
+static void Test19()
+{
+    cout << "\n****** TEST 19\n";
+    const char *fileRequests = "ECElevatorTest_requests.txt";
+    {
+        ofstream outfile(fileRequests, ios::binary);
+        outfile << "# requests\n\n  # indented comment\n8 40\r\n5 2 7\r\n1 8 1  # late comment\n5 6 3\n\n0 4 5";
+    }
+    for (int numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        ECRequestFileHeader header;
+        ECElevatorRequestStore store;
+        string strError;
+        ASSERT_EQ(ECLoadRequestFile(fileRequests, header, store, strError, numThreads), true);
+        ASSERT_EQ(header.numFloors, 8);
+        ASSERT_EQ(header.timeSim, 40);
+        ASSERT_EQ(store.GetSize(), (size_t)4);
+        ASSERT_EQ(store.IsSortedByTime(), true);
+        ASSERT_EQ(store.GetFloorSrc(0), 4);
+        ASSERT_EQ(store.GetFloorSrc(1), 8);
+        ASSERT_EQ(store.GetFloorSrc(2), 2);
+        ASSERT_EQ(store.GetFloorSrc(3), 6);
+    }
+
+    {
+        ofstream outfile(fileRequests, ios::binary);
+        outfile << "8 40\n5 2 7\n# fine\n6 3\n";
+    }
+    ECRequestFileHeader header;
+    ECElevatorRequestStore store;
+    string strError;
+    ASSERT_EQ(ECLoadRequestFile(fileRequests, header, store, strError), false);
+    ASSERT_EQ(strError, string("line 4: expected \"time floorSrc floorDest\""));
+    {
+        ofstream outfile(fileRequests, ios::binary);
+        outfile << "# no floors\n0 40\n5 2 7\n";
+    }
+    ASSERT_EQ(ECLoadRequestFile(fileRequests, header, store, strError), false);
+    ASSERT_EQ(strError.substr(0, 7), string("line 2:"));
+    remove(fileRequests);
+}
+
+// Snapshot with a valid header but a bad body (car on a floor the building does
+// not have, arrival cursor past the arrivals, body cut short): restoring fails and
+// the simulator goes on as if nothing happened (the arrival times of test 7)
+static void Test20()
+{
+    cout << "\n****** TEST 20\n";
+    const int NUM_FLOORS = 10;
+    const int timeSim = 30;
+    ECElevatorSimRequest r1(0, 6, 2), r2(1, 4, 9);
+    vector<ECElevatorSimRequest> listRequests;
+    listRequests.push_back(r1);
+    listRequests.push_back(r2);
+    vector<ECElevatorSimRequest> listRequestsOther(listRequests);
+
+    ECElevatorSim sim(NUM_FLOORS, listRequests);
+    sim.Simulate(5);
+    vector<char> snapshot;
+    sim.SaveSnapshot(snapshot);
+
+    // header: magic, version, size (8 bytes), floors, streaming flag (1 byte), request
+    // count (8 bytes); then time, floor, direction, last direction, in-order flag
+    // (1 byte) and the arrival order (count, then 4 bytes each) before the cursor
+    const size_t POS_FLOOR = 4 + 4 + 8 + 4 + 1 + 8 + 4;
+    const size_t POS_ARRIVALS = POS_FLOOR + 4 + 4 + 4 + 1;
+    uint64_t numArrivals = 0;
+    memcpy(&numArrivals, &snapshot[POS_ARRIVALS], sizeof(numArrivals));
+    const size_t POS_CURSOR = POS_ARRIVALS + 8 + 4 * numArrivals;
+
+    ECElevatorSim simOther(NUM_FLOORS, listRequestsOther);
+    simOther.Simulate(2);
+
+    vector<char> snapshotBad(snapshot);
+    int32_t floorBad = NUM_FLOORS + 5;
+    memcpy(&snapshotBad[POS_FLOOR], &floorBad, sizeof(floorBad));
+    ASSERT_EQ(simOther.RestoreSnapshot(snapshotBad.data(), snapshotBad.size()), false);
+
+    snapshotBad = snapshot;
+    uint64_t cursorBad = 1000;
+    memcpy(&snapshotBad[POS_CURSOR], &cursorBad, sizeof(cursorBad));
+    ASSERT_EQ(simOther.RestoreSnapshot(snapshotBad.data(), snapshotBad.size()), false);
+
+    snapshotBad.assign(snapshot.begin(), snapshot.end() - 16);
+    uint64_t sizeBad = snapshotBad.size();
+    memcpy(&snapshotBad[8], &sizeBad, sizeof(sizeBad));
+    ASSERT_EQ(simOther.RestoreSnapshot(snapshotBad.data(), snapshotBad.size()), false);
+
+    ASSERT_EQ(simOther.GetTimeElapsed(), 2);
+    simOther.Simulate(timeSim);
+    ASSERT_EQ(listRequestsOther[0].GetArriveTime(), 18);
+    ASSERT_EQ(listRequestsOther[1].GetArriveTime(), 10);
+}
+
+// Bank of two cars, both idle at floor 1: three requests no car can service (floor 0,
+// floor 12, same floor) go to no car and add no load, so the passenger at floor 1
+// (time 10) still goes to the first car and arrives at floor 4 at time 13
+static void Test21()
+{
+    cout << "\n****** TEST 21\n";
+    const int NUM_FLOORS = 10;
+    const int timeSim = 30;
+    ECElevatorRequestStore store;
+    store.Add(1, 0, 3);
+    store.Add(2, 3, 12);
+    store.Add(3, 5, 5);
+    store.Add(10, 1, 4);
+    ECElevatorBank bank(NUM_FLOORS, 2, store);
+    bank.Simulate(timeSim);
+    ASSERT_EQ(bank.GetAssignedCar(0), -1);
+    ASSERT_EQ(bank.GetAssignedCar(1), -1);
+    ASSERT_EQ(bank.GetAssignedCar(2), -1);
+    ASSERT_EQ(bank.GetAssignedCar(3), 0);
+    ASSERT_EQ(store.GetArriveTime(3), 13);
+    ASSERT_EQ(bank.GetStats().GetNumRequests(), 1LL);
+}
+
+// Work-stealing pool, two threads, six jobs longest first (40, 30, 20, 10, 5, 1 ms):
+// each thread starts with the longest job of its queue (job 0 or 1) and runs its own
+// jobs in the order given; only stolen jobs come out of order
+static void Test22()
+{
+    cout << "\n****** TEST 22\n";
+    const int listCostsMs[] = {40, 30, 20, 10, 5, 1};
+    const int NUM_JOBS = 6, NUM_THREADS = 2;
+    mutex lockOrder;
+    vector<pair<thread::id, int>> listOrder;
+    vector<function<void()>> listJobs;
+    for (int i = 0; i < NUM_JOBS; ++i)
+    {
+        listJobs.push_back([i, &listCostsMs, &lockOrder, &listOrder]() {
+            {
+                lock_guard<mutex> guard(lockOrder);
+                listOrder.push_back(make_pair(this_thread::get_id(), i));
+            }
+            this_thread::sleep_for(chrono::milliseconds(listCostsMs[i]));
+        });
+    }
+    ECWorkStealingPool pool(NUM_THREADS);
+    pool.Run(listJobs);
+    ASSERT_EQ((int)listOrder.size(), NUM_JOBS);
+
+    map<thread::id, vector<int>> mapJobsByThread;
+    for (const auto &entry : listOrder)
+    {
+        mapJobsByThread[entry.first].push_back(entry.second);
+    }
+    for (const auto &entry : mapJobsByThread)
+    {
+        const vector<int> &listJobsRun = entry.second;
+        int queue = listJobsRun[0] % NUM_THREADS;
+        ASSERT_EQ(listJobsRun[0], queue);
+        vector<int> listOwn;
+        for (int job : listJobsRun)
+        {
+            if (job % NUM_THREADS == queue)
+            {
+                listOwn.push_back(job);
+            }
+        }
+        ASSERT_EQ(is_sorted(listOwn.begin(), listOwn.end()), true);
+    }
+}
+
+// Snapshot of two passengers waiting at floor 9 to go down (chained 0 -> 1), with
+// the chain made a cycle (1 -> 0), or with one waiting passenger less than queued:
+// restoring fails (a cycle would make the car loop forever once it gets there); the
+// snapshot as saved restores, and both simulators then give the same arrival times
+static void Test23()
+{
+    cout << "\n****** TEST 23\n";
+    const int NUM_FLOORS = 10;
+    ECElevatorRequestStore store, storeOther;
+    store.Add(0, 9, 2);
+    store.Add(0, 9, 3);
+    storeOther.Add(0, 9, 2);
+    storeOther.Add(0, 9, 3);
+    ECElevatorSim sim(NUM_FLOORS, store);
+    sim.Simulate(2);
+    ASSERT_EQ(sim.GetNumPendingRequests(), 2);
+    vector<char> snapshot;
+    sim.SaveSnapshot(snapshot);
+
+    // the waiting chain: count 2, then next of request 0 (1) and of request 1 (-1);
+    // the cabin chain follows (count 2 and two entries), then the waiting total
+    const int32_t listChain[] = {2, 0, 1, -1};
+    size_t posChain = 0;
+    int numFound = 0;
+    for (size_t pos = 0; pos + sizeof(listChain) <= snapshot.size(); ++pos)
+    {
+        if (memcmp(&snapshot[pos], listChain, sizeof(listChain)) == 0)
+        {
+            posChain = pos;
+            ++numFound;
+        }
+    }
+    ASSERT_EQ(numFound, 1);
+
+    ECElevatorSim simOther(NUM_FLOORS, storeOther);
+    simOther.Simulate(2);
+
+    vector<char> snapshotBad(snapshot);
+    int32_t reqCycle = 0;
+    memcpy(&snapshotBad[posChain + 12], &reqCycle, sizeof(reqCycle));
+    ASSERT_EQ(simOther.RestoreSnapshot(snapshotBad.data(), snapshotBad.size()), false);
+
+    snapshotBad = snapshot;
+    int32_t numWaitingBad = 1;
+    memcpy(&snapshotBad[posChain + 32], &numWaitingBad, sizeof(numWaitingBad));
+    ASSERT_EQ(simOther.RestoreSnapshot(snapshotBad.data(), snapshotBad.size()), false);
+
+    ASSERT_EQ(simOther.RestoreSnapshot(snapshot.data(), snapshot.size()), true);
+    sim.Simulate(30);
+    simOther.Simulate(30);
+    ASSERT_EQ(storeOther.GetArriveTime(0), store.GetArriveTime(0));
+    ASSERT_EQ(storeOther.GetArriveTime(1), store.GetArriveTime(1));
+    ASSERT_EQ(storeOther.IsServiced(1), true);
+}
+
+// One request file through both parsers (ECRequestReader line by line, and
+// ECLoadRequestFile): indented comments and blank lines before the header, comments
+// after numbers and Windows line ends give the same header and requests (the loader
+// sorts them by time); a bad line stops both, with the same error
+static void Test24()
+{
+    cout << "\n****** TEST 24\n";
+    const char *fileRequests = "ECElevatorTest_requests.txt";
+    const string strFile = "  # indented comment\n \t\n\t# tab\n8 40 # header\r\n5 2 7\r\n  # more\n1 8 1# late\n5 6 3\n\n0 4 5";
+    {
+        ofstream outfile(fileRequests, ios::binary);
+        outfile << strFile;
+    }
+    ECRequestFileHeader header;
+    ECElevatorRequestStore store;
+    string strError;
+    ASSERT_EQ(ECLoadRequestFile(fileRequests, header, store, strError), true);
+
+    istringstream iss(strFile);
+    ECRequestReader reader(iss);
+    ASSERT_EQ(reader.GetNumFloors(), header.numFloors);
+    ASSERT_EQ(reader.GetTimeSim(), header.timeSim);
+    ECElevatorRequestStore storeRead;
+    int time, floorSrc, floorDest;
+    while (reader.GetNext(time, floorSrc, floorDest))
+    {
+        storeRead.Add(time, floorSrc, floorDest);
+    }
+    ASSERT_EQ(reader.HasError(), false);
+    ASSERT_EQ(storeRead.GetSize(), store.GetSize());
+    vector<int> listOrder(storeRead.GetSize());
+    for (size_t i = 0; i < listOrder.size(); ++i)
+    {
+        listOrder[i] = (int)i;
+    }
+    stable_sort(listOrder.begin(), listOrder.end(), [&storeRead](int a, int b) { return storeRead.GetTime(a) < storeRead.GetTime(b); });
+    bool fSame = storeRead.GetSize() == store.GetSize();
+    for (size_t i = 0; fSame && i < listOrder.size(); ++i)
+    {
+        int req = listOrder[i];
+        fSame = storeRead.GetTime(req) == store.GetTime((int)i) && storeRead.GetFloorSrc(req) == store.GetFloorSrc((int)i) &&
+                storeRead.GetFloorDest(req) == store.GetFloorDest((int)i);
+    }
+    ASSERT_EQ(fSame, true);
+
+    const string strBad = "8 40\n5 2 7\n  # fine\n6 3\n7 1 2\n";
+    {
+        ofstream outfile(fileRequests, ios::binary);
+        outfile << strBad;
+    }
+    ASSERT_EQ(ECLoadRequestFile(fileRequests, header, store, strError), false);
+    istringstream issBad(strBad);
+    ECRequestReader readerBad(issBad);
+    int numRead = 0;
+    while (readerBad.GetNext(time, floorSrc, floorDest))
+    {
+        ++numRead;
+    }
+    ASSERT_EQ(numRead, 1);
+    ASSERT_EQ(readerBad.GetError(), strError);
+    remove(fileRequests);
+}
+
+// Bank of two cars, hall calls by direction: car 1 is on its way up to floor 5 for
+// a passenger going up (time 2); a passenger going down at floor 5 (time 5) goes to
+// car 0, which is about to stop there (dropping off the passenger of time 0), and
+// arrives at floor 1 at time 9 (car 1 would only bring it down at time 20)
+static void Test25()
+{
+    cout << "\n****** TEST 25\n";
+    const int NUM_FLOORS = 10;
+    ECElevatorRequestStore store;
+    store.Add(0, 1, 5);
+    store.Add(2, 5, 9);
+    store.Add(5, 5, 1);
+    ECElevatorBank bank(NUM_FLOORS, 2, store);
+    bank.Simulate(40);
+    ASSERT_EQ(bank.GetAssignedCar(0), 0);
+    ASSERT_EQ(bank.GetAssignedCar(1), 1);
+    ASSERT_EQ(bank.GetAssignedCar(2), 0);
+    ASSERT_EQ(store.GetArriveTime(0), 4);
+    ASSERT_EQ(store.GetArriveTime(1), 11);
+    ASSERT_EQ(store.GetArriveTime(2), 9);
+}
 
 int main()
 {
@@ -180,4 +941,25 @@ int main()
     Test2();
     Test3();
     Test4();
+    Test5();
+    Test6();
+    Test7();
+    Test8();
+    Test9();
+    Test10();
+    Test11();
+    Test12();
+    Test13();
+    Test14();
+    Test15();
+    Test16();
+    Test17();
+    Test18();
+    Test19();
+    Test20();
+    Test21();
+    Test22();
+    Test23();
+    Test24();
+    Test25();
 }
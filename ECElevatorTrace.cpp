@@ -0,0 +1,419 @@
+//
+//  ECElevatorTrace.cpp
+//
+//
+//  Binary request traces, memory-mapped and read in place
+
+#include "ECElevatorTrace.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <thread>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static_assert(sizeof(ECTraceHeader) == 32, "trace header layout");
+static_assert(sizeof(ECTraceRecord) == 8, "trace record layout");
+
+//*****************************************************************************
+// Mapping
+
+#if defined(__unix__) || defined(__APPLE__)
+
+bool ECMappedFile::Open(const std::string &path, bool fWritable, std::string &strError)
+{
+    Close();
+    int fd = open(path.c_str(), fWritable ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+    {
+        strError = "could not open " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        strError = "could not open " + path;
+        return false;
+    }
+    if (st.st_size == 0)
+    {
+        close(fd);
+        return true;
+    }
+    void *dataMapped = mmap(nullptr, st.st_size, fWritable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (dataMapped == MAP_FAILED)
+    {
+        strError = "could not map " + path;
+        return false;
+    }
+    data = static_cast<char *>(dataMapped);
+    size = st.st_size;
+    // read front to back
+    madvise(data, size, MADV_SEQUENTIAL);
+    return true;
+}
+
+void ECMappedFile::Close()
+{
+    if (data != nullptr)
+    {
+        munmap(data, size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+#else
+
+bool ECMappedFile::Open(const std::string &path, bool, std::string &strError)
+{
+    strError = "memory-mapped files need a POSIX system: " + path;
+    return false;
+}
+
+void ECMappedFile::Close() {}
+
+#endif
+
+static bool IsValidTrace(const ECMappedFile &file, const std::string &path, std::string &strError)
+{
+    if (file.GetSize() < sizeof(ECTraceHeader))
+    {
+        strError = path + " is too short for a trace";
+        return false;
+    }
+    const ECTraceHeader &header = *reinterpret_cast<const ECTraceHeader *>(file.GetData());
+    if (header.magic != EC_TRACE_MAGIC)
+    {
+        strError = "not a trace file";
+        return false;
+    }
+    if (header.version != EC_TRACE_VERSION || header.sizeRecord != sizeof(ECTraceRecord))
+    {
+        strError = "unsupported trace version " + to_string(header.version);
+        return false;
+    }
+    size_t sizeRecords = file.GetSize() - sizeof(ECTraceHeader);
+    if (header.numRequests != sizeRecords / sizeof(ECTraceRecord) || sizeRecords % sizeof(ECTraceRecord) != 0)
+    {
+        strError = "trace size does not match its " + to_string(header.numRequests) + " requests";
+        return false;
+    }
+    return true;
+}
+
+bool ECTraceFile::Open(const std::string &path, std::string &strError)
+{
+    if (!file.Open(path, false, strError) || !IsValidTrace(file, path, strError))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+//*****************************************************************************
+// Writing
+
+ECTraceWriter::ECTraceWriter() : timeLast(0), fInOrder(true), fFailed(false)
+{
+    header = {EC_TRACE_MAGIC, EC_TRACE_VERSION, 0, 0, 0, sizeof(ECTraceRecord), 0};
+}
+
+bool ECTraceWriter::Open(const std::string &path, int numFloors, int timeSim)
+{
+    Close();
+    header = {EC_TRACE_MAGIC, EC_TRACE_VERSION, numFloors, timeSim, 0, sizeof(ECTraceRecord), 0};
+    fInOrder = true;
+    fFailed = false;
+    buffer.reserve(1 << 13);
+    os.open(path, ios::binary | ios::trunc);
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    return (bool)os;
+}
+
+bool ECTraceWriter::Write(int time, int floorSrc, int floorDest)
+{
+    if (floorSrc < SHRT_MIN || floorSrc > SHRT_MAX || floorDest < SHRT_MIN || floorDest > SHRT_MAX)
+    {
+        return false;
+    }
+    if (header.numRequests > 0 && time < timeLast)
+    {
+        fInOrder = false;
+    }
+    timeLast = time;
+    buffer.push_back({time, (int16_t)floorSrc, (int16_t)floorDest});
+    ++header.numRequests;
+    if (buffer.size() == buffer.capacity())
+    {
+        Flush();
+    }
+    return true;
+}
+
+void ECTraceWriter::Flush()
+{
+    if (!buffer.empty())
+    {
+        os.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(ECTraceRecord));
+        buffer.clear();
+    }
+    fFailed = fFailed || !os;
+}
+
+bool ECTraceWriter::Close()
+{
+    if (!os.is_open())
+    {
+        return !fFailed;
+    }
+    Flush();
+    os.seekp(0);
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    fFailed = fFailed || !os;
+    os.close();
+    return !fFailed;
+}
+
+//*****************************************************************************
+// Conversions
+
+bool ECConvertTextTrace(std::istream &is, const std::string &pathTrace, std::string &strError)
+{
+    ECRequestReader reader(is);
+    if (reader.GetNumFloors() <= 0)
+    {
+        strError = reader.HasError() ? reader.GetError() : "missing \"numFloors timeSim\" header";
+        return false;
+    }
+    ECTraceWriter writer;
+    if (!writer.Open(pathTrace, reader.GetNumFloors(), reader.GetTimeSim()))
+    {
+        strError = "could not write " + pathTrace;
+        return false;
+    }
+    int time, floorSrc, floorDest;
+    while (reader.GetNext(time, floorSrc, floorDest))
+    {
+        if (!writer.Write(time, floorSrc, floorDest))
+        {
+            strError = "floor out of range in request " + to_string(writer.GetNumRequests() + 1);
+            return false;
+        }
+    }
+    if (reader.HasError())
+    {
+        strError = reader.GetError();
+        return false;
+    }
+    if (!writer.Close())
+    {
+        strError = "could not write " + pathTrace;
+        return false;
+    }
+    return writer.IsInOrder() || ECSortTraceFile(pathTrace, strError);
+}
+
+bool ECConvertBinaryTrace(const std::string &pathTrace, std::ostream &os, std::string &strError)
+{
+    ECTraceFile trace;
+    if (!trace.Open(pathTrace, strError))
+    {
+        return false;
+    }
+    ECRequestFileWriter writer(os, trace.GetNumFloors(), trace.GetTimeSim());
+    for (const ECTraceRecord &record : trace)
+    {
+        writer.Write(record.time, record.floorSrc, record.floorDest);
+    }
+    writer.Flush();
+    if (!os)
+    {
+        strError = "writing the requests failed";
+        return false;
+    }
+    return true;
+}
+
+bool ECSortTraceFile(const std::string &pathTrace, std::string &strError)
+{
+    ECMappedFile file;
+    if (!file.Open(pathTrace, true, strError) || !IsValidTrace(file, pathTrace, strError))
+    {
+        return false;
+    }
+    ECTraceRecord *records = reinterpret_cast<ECTraceRecord *>(file.GetData() + sizeof(ECTraceHeader));
+    size_t numRequests = reinterpret_cast<const ECTraceHeader *>(file.GetData())->numRequests;
+    stable_sort(records, records + numRequests,
+                [](const ECTraceRecord &r1, const ECTraceRecord &r2) { return r1.time < r2.time; });
+    return true;
+}
+
+//*****************************************************************************
+// Loading request files
+
+struct ECParsedChunk
+{
+    std::vector<ECTraceRecord> listRecords;
+    const char *posError = nullptr;     // start of the first bad line
+    std::string strError;
+};
+
+static void ParseChunk(const char *begin, const char *end, ECParsedChunk &chunk)
+{
+    // a request line is about 10 characters
+    chunk.listRecords.reserve((end - begin) / 10);
+    bool fSorted = true;
+    int listValues[3];
+    bool fEmpty, fValid;
+    for (const char *pos = begin; pos < end;)
+    {
+        const char *posLine = pos;
+        pos = ECParseRequestLine(pos, end, listValues, 3, fEmpty, fValid);
+        if (fEmpty)
+        {
+            continue;
+        }
+        if (!fValid || !ECIsRequestLineValid(listValues))
+        {
+            chunk.posError = posLine;
+            chunk.strError = fValid ? "floor out of range" : "expected \"time floorSrc floorDest\"";
+            return;
+        }
+        fSorted = fSorted && (chunk.listRecords.empty() || listValues[0] >= chunk.listRecords.back().time);
+        chunk.listRecords.push_back({listValues[0], (int16_t)listValues[1], (int16_t)listValues[2]});
+    }
+    if (!fSorted)
+    {
+        stable_sort(chunk.listRecords.begin(), chunk.listRecords.end(),
+                    [](const ECTraceRecord &r1, const ECTraceRecord &r2) { return r1.time < r2.time; });
+    }
+}
+
+static std::string GetLineName(const char *begin, const char *pos)
+{
+    return "line " + to_string(1 + count(begin, pos, '\n'));
+}
+
+bool ECLoadRequestFile(const std::string &path, ECRequestFileHeader &header, ECElevatorRequestStore &store,
+                       std::string &strError, int numThreads)
+{
+    ECMappedFile file;
+    if (!file.Open(path, false, strError))
+    {
+        return false;
+    }
+    const char *begin = file.GetData();
+    const char *end = begin + file.GetSize();
+
+    // header: the first line that is not blank or a comment
+    const char *pos = begin, *posHeader = begin;
+    int listValues[2];
+    bool fEmpty = true, fValid = false;
+    while (pos < end && fEmpty)
+    {
+        posHeader = pos;
+        pos = ECParseRequestLine(pos, end, listValues, 2, fEmpty, fValid);
+    }
+    if (fEmpty)
+    {
+        strError = "missing \"numFloors timeSim\" header";
+        return false;
+    }
+    if (!fValid || !ECIsHeaderLineValid(listValues))
+    {
+        strError = GetLineName(begin, posHeader) + ": header is not \"numFloors timeSim\" with 1 to 32767 floors";
+        return false;
+    }
+    header.numFloors = listValues[0];
+    header.timeSim = listValues[1];
+
+    // chunks of 1 MB or more, each starting at a line
+    if (numThreads <= 0)
+    {
+        numThreads = max(1u, thread::hardware_concurrency());
+    }
+    size_t sizeRest = end - pos;
+    int numChunks = (int)max<size_t>(1, min<size_t>(numThreads, sizeRest >> 20));
+    vector<const char *> listBounds(1, pos);
+    for (int i = 1; i < numChunks; ++i)
+    {
+        const char *posBound = max(pos + sizeRest * i / numChunks, listBounds.back());
+        const char *posNewline = static_cast<const char *>(memchr(posBound, '\n', end - posBound));
+        listBounds.push_back(posNewline != nullptr ? posNewline + 1 : end);
+    }
+    listBounds.push_back(end);
+
+    vector<ECParsedChunk> listChunks(numChunks);
+    vector<thread> listThreads;
+    for (int i = 1; i < numChunks; ++i)
+    {
+        listThreads.emplace_back(ParseChunk, listBounds[i], listBounds[i + 1], ref(listChunks[i]));
+    }
+    ParseChunk(listBounds[0], listBounds[1], listChunks[0]);
+    for (thread &th : listThreads)
+    {
+        th.join();
+    }
+    for (const ECParsedChunk &chunk : listChunks)
+    {
+        if (chunk.posError != nullptr)
+        {
+            strError = GetLineName(begin, chunk.posError) + ": " + chunk.strError;
+            return false;
+        }
+    }
+
+    // each chunk is in time order: merge them, earlier chunks first on ties (when
+    // the file is in time order, the chunks just follow each other)
+    store.Clear();
+    size_t numRequests = 0;
+    bool fChunksInOrder = true;
+    int timeLast = INT_MIN;
+    for (const ECParsedChunk &chunk : listChunks)
+    {
+        numRequests += chunk.listRecords.size();
+        if (!chunk.listRecords.empty())
+        {
+            fChunksInOrder = fChunksInOrder && chunk.listRecords.front().time >= timeLast;
+            timeLast = chunk.listRecords.back().time;
+        }
+    }
+    store.Reserve(numRequests);
+    if (fChunksInOrder)
+    {
+        for (const ECParsedChunk &chunk : listChunks)
+        {
+            for (const ECTraceRecord &record : chunk.listRecords)
+            {
+                store.Add(record.time, record.floorSrc, record.floorDest);
+            }
+        }
+        return true;
+    }
+    vector<size_t> listNext(numChunks, 0);
+    for (size_t n = 0; n < numRequests; ++n)
+    {
+        int iChunk = -1;
+        for (int i = 0; i < numChunks; ++i)
+        {
+            if (listNext[i] < listChunks[i].listRecords.size() &&
+                (iChunk < 0 || listChunks[i].listRecords[listNext[i]].time < listChunks[iChunk].listRecords[listNext[iChunk]].time))
+            {
+                iChunk = i;
+            }
+        }
+        const ECTraceRecord &record = listChunks[iChunk].listRecords[listNext[iChunk]++];
+        store.Add(record.time, record.floorSrc, record.floorDest);
+    }
+    return true;
+}
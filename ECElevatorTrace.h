@@ -0,0 +1,163 @@
+//
+//  ECElevatorTrace.h
+//
+//
+//  Request traces: binary traces mapped and read in place, and request files
+//  loaded in parallel
+
+#ifndef ECElevatorTrace_h
+#define ECElevatorTrace_h
+
+#include "ECElevatorSim.h"
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Trace layout: a 32-byte header, then one fixed-width record per request in
+// time order (requests made at the same time keep the order they were written
+// in). Values are stored as they are in memory, so a trace is read back on the
+// same kind of machine (a trace from another byte order fails the magic check)
+
+const uint32_t EC_TRACE_MAGIC = 0x52544345; // "ECTR"
+const uint32_t EC_TRACE_VERSION = 1;
+
+struct ECTraceHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    int32_t numFloors;
+    int32_t timeSim;
+    uint64_t numRequests;
+    uint32_t sizeRecord;        // bytes per record
+    uint32_t reserved;
+};
+
+// Floors fit in 16 bits, as in ECElevatorRequestStore
+struct ECTraceRecord
+{
+    int32_t time;
+    int16_t floorSrc;
+    int16_t floorDest;
+
+    int GetTime() const { return time; }
+    int GetFloorSrc() const { return floorSrc; }
+    int GetFloorDest() const { return floorDest; }
+};
+
+//*****************************************************************************
+// A whole file mapped into memory (shared, so writes go to the file)
+
+class ECMappedFile
+{
+public:
+    ECMappedFile() : data(nullptr), size(0) {}
+    ~ECMappedFile() { Close(); }
+    ECMappedFile(const ECMappedFile &) = delete;
+    ECMappedFile &operator=(const ECMappedFile &) = delete;
+
+    // false (with the reason in strError) if the file can't be opened or mapped;
+    // an empty file maps to no data
+    bool Open(const std::string &path, bool fWritable, std::string &strError);
+    void Close();
+    char *GetData() const { return data; }
+    size_t GetSize() const { return size; }
+
+private:
+    char *data;
+    size_t size;
+};
+
+//*****************************************************************************
+// A trace file mapped read-only: records are used where they are, with no
+// parsing or copying, and runs on the same file share the page cache
+
+class ECTraceFile
+{
+public:
+    // false (with the reason in strError) if the file can't be mapped or is not
+    // a trace of this version whose size matches its request count
+    bool Open(const std::string &path, std::string &strError);
+    void Close() { file.Close(); }
+
+    const ECTraceHeader &GetHeader() const { return *reinterpret_cast<const ECTraceHeader *>(file.GetData()); }
+    int GetNumFloors() const { return GetHeader().numFloors; }
+    int GetTimeSim() const { return GetHeader().timeSim; }
+    size_t GetNumRequests() const { return GetHeader().numRequests; }
+    const ECTraceRecord *begin() const
+    {
+        return reinterpret_cast<const ECTraceRecord *>(file.GetData() + sizeof(ECTraceHeader));
+    }
+    const ECTraceRecord *end() const { return begin() + GetNumRequests(); }
+
+private:
+    ECMappedFile file;
+};
+
+// Requests of a mapped trace, for a streaming simulation
+typedef ECIteratorRequestSource<const ECTraceRecord *> ECTraceRequestSource;
+
+//*****************************************************************************
+// Traces written a request at a time through a buffer; the header's request
+// count is filled in by Close
+
+class ECTraceWriter
+{
+public:
+    ECTraceWriter();
+    ~ECTraceWriter() { Close(); }
+
+    bool Open(const std::string &path, int numFloors, int timeSim);
+    // false if the floors don't fit in a record
+    bool Write(int time, int floorSrc, int floorDest);
+    // false if any write failed
+    bool Close();
+
+    uint64_t GetNumRequests() const { return header.numRequests; }
+    // whether every request was made no earlier than the one before
+    bool IsInOrder() const { return fInOrder; }
+
+private:
+    void Flush();
+
+    std::ofstream os;
+    ECTraceHeader header;
+    std::vector<ECTraceRecord> buffer;
+    int timeLast;
+    bool fInOrder;
+    bool fFailed;
+};
+
+//*****************************************************************************
+// Conversions. From a request file (comments and header as ECRequestReader reads
+// them): requests out of time order are sorted (stably) in the written file
+
+bool ECConvertTextTrace(std::istream &is, const std::string &pathTrace, std::string &strError);
+bool ECConvertBinaryTrace(const std::string &pathTrace, std::ostream &os, std::string &strError);
+
+// Sorts the records of a trace file in place by time, keeping the order of
+// requests made at the same time
+bool ECSortTraceFile(const std::string &pathTrace, std::string &strError);
+
+//*****************************************************************************
+// A request file loaded at once. The file is mapped and split into chunks on line
+// boundaries, and the chunks are parsed on numThreads threads (0: one per core).
+// Lines are read as ECRequestReader reads them (ECParseRequestLine, in
+// ECElevatorRequestStream.h). The requests replace what is in store, in time
+// order (requests made at the same time keep their order in the file)
+
+struct ECRequestFileHeader
+{
+    int numFloors;
+    int timeSim;
+};
+
+// false, with the reason (and line) in strError, if the file can't be read, the
+// header is missing or out of range (1 to 32767 floors, time not negative), or
+// a request line is not three numbers with floors that fit in 16 bits
+bool ECLoadRequestFile(const std::string &path, ECRequestFileHeader &header, ECElevatorRequestStore &store,
+                       std::string &strError, int numThreads = 0);
+
+#endif /* ECElevatorTrace_h */
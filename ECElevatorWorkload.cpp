@@ -0,0 +1,232 @@
+//
+//  ECElevatorWorkload.cpp
+//
+//
+//  Reproducible synthetic workloads: Poisson arrivals over a time-of-day profile
+
+#include "ECElevatorWorkload.h"
+#include <algorithm>
+
+using namespace std;
+
+//*****************************************************************************
+// Alias tables (Vose): floors are split into those above and below the average
+// weight, and each column is filled up with a floor from above
+
+void ECFloorSampler::Init(const std::vector<double> &listWeights, int floorFirst)
+{
+    this->floorFirst = floorFirst;
+    listProb.clear();
+    listAlias.clear();
+    double total = 0.0;
+    for (double weight : listWeights)
+    {
+        total += max(weight, 0.0);
+    }
+    if (total <= 0.0)
+    {
+        return;
+    }
+
+    int num = (int)listWeights.size();
+    listProb.resize(num);
+    listAlias.resize(num);
+    vector<int> listSmall, listLarge;
+    for (int i = 0; i < num; ++i)
+    {
+        listProb[i] = max(listWeights[i], 0.0) * num / total;
+        listAlias[i] = i;
+        (listProb[i] < 1.0 ? listSmall : listLarge).push_back(i);
+    }
+    while (!listSmall.empty() && !listLarge.empty())
+    {
+        int small = listSmall.back();
+        int large = listLarge.back();
+        listSmall.pop_back();
+        listAlias[small] = large;
+        listProb[large] -= 1.0 - listProb[small];
+        if (listProb[large] < 1.0)
+        {
+            listLarge.pop_back();
+            listSmall.push_back(large);
+        }
+    }
+    // what is left is 1 up to rounding
+    for (int i : listSmall)
+    {
+        listProb[i] = 1.0;
+    }
+    for (int i : listLarge)
+    {
+        listProb[i] = 1.0;
+    }
+}
+
+//*****************************************************************************
+// Profiles
+
+const char *ECGetProfileName(EC_WORKLOAD_PROFILE profile)
+{
+    static const char *listNames[EC_NUM_PROFILES] = {"uniform", "uppeak", "lunch", "downpeak", "day"};
+    return listNames[profile];
+}
+
+bool ECParseProfile(const std::string &name, EC_WORKLOAD_PROFILE &profile)
+{
+    for (int i = 0; i < EC_NUM_PROFILES; ++i)
+    {
+        if (name == ECGetProfileName((EC_WORKLOAD_PROFILE)i))
+        {
+            profile = (EC_WORKLOAD_PROFILE)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ECGetProfilePhases(EC_WORKLOAD_PROFILE profile, std::vector<ECTrafficPhase> &listPhases)
+{
+    switch (profile)
+    {
+    case EC_PROFILE_UP_PEAK:
+        listPhases = {{1.0, 1.0, 0.85, 0.03}};
+        break;
+    case EC_PROFILE_LUNCH:
+        listPhases = {{0.5, 1.0, 0.15, 0.6}, {1.0, 1.0, 0.6, 0.15}};
+        break;
+    case EC_PROFILE_DOWN_PEAK:
+        listPhases = {{1.0, 1.0, 0.03, 0.85}};
+        break;
+    case EC_PROFILE_DAY:
+        // 12 hours from 7:00: each phase is an hour or more
+        listPhases = {{0.08, 0.6, 0.7, 0.05},  {0.2, 2.0, 0.85, 0.03}, {0.42, 0.8, 0.2, 0.2}, {0.5, 1.6, 0.15, 0.6},
+                      {0.58, 1.6, 0.6, 0.15},  {0.8, 0.8, 0.2, 0.2},   {0.92, 2.0, 0.03, 0.85}, {1.0, 0.6, 0.05, 0.7}};
+        break;
+    default:
+        listPhases = {{1.0, 1.0, 0.0, 0.0}};
+        break;
+    }
+}
+
+//*****************************************************************************
+// Generator
+
+static vector<ECTrafficPhase> GetProfilePhases(EC_WORKLOAD_PROFILE profile)
+{
+    vector<ECTrafficPhase> listPhases;
+    ECGetProfilePhases(profile, listPhases);
+    return listPhases;
+}
+
+ECWorkloadGenerator::ECWorkloadGenerator(int numFloors, long long numRequests, int timeSim, EC_WORKLOAD_PROFILE profile,
+                                         uint64_t seed)
+    : ECWorkloadGenerator(numFloors, numRequests, timeSim, GetProfilePhases(profile), seed)
+{
+}
+
+ECWorkloadGenerator::ECWorkloadGenerator(int numFloors, long long numRequests, int timeSim,
+                                         const std::vector<ECTrafficPhase> &listPhasesIn, uint64_t seed)
+    : numFloors(numFloors), numRequests(numRequests), timeSim(timeSim), listPhases(listPhasesIn), rng(seed),
+      numGenerated(0), logRemain(0.0), phaseCurr(0)
+{
+    if (listPhases.empty())
+    {
+        ECGetProfilePhases(EC_PROFILE_UNIFORM, listPhases);
+    }
+    // the last phase ends the day
+    listPhases.back().timeEnd = 1.0;
+    double timeStart = 0.0, total = 0.0;
+    for (const ECTrafficPhase &phase : listPhases)
+    {
+        total += max(phase.rate, 0.0) * (phase.timeEnd - timeStart);
+        listCumRate.push_back(total);
+        timeStart = phase.timeEnd;
+    }
+    for (double &cumRate : listCumRate)
+    {
+        cumRate = total > 0.0 ? cumRate / total : 1.0;
+    }
+    SetPhaseScale();
+    SetFloorWeights(vector<double>());
+}
+
+// Time goes linearly with the share of requests within a phase
+void ECWorkloadGenerator::SetPhaseScale()
+{
+    double timeStart = phaseCurr > 0 ? listPhases[phaseCurr - 1].timeEnd : 0.0;
+    sharePhase = phaseCurr > 0 ? listCumRate[phaseCurr - 1] : 0.0;
+    double shareSpan = listCumRate[phaseCurr] - sharePhase;
+    timePhase = timeStart * timeSim;
+    timePerShare = shareSpan > 0.0 ? (listPhases[phaseCurr].timeEnd - timeStart) * timeSim / shareSpan : 0.0;
+}
+
+void ECWorkloadGenerator::SetFloorWeights(const std::vector<double> &listWeights)
+{
+    vector<double> listAll(max(numFloors, 0), 1.0);
+    for (size_t i = 0; i < listWeights.size() && i < listAll.size(); ++i)
+    {
+        listAll[i] = listWeights[i];
+    }
+    samplerAll.Init(listAll, 1);
+    if (listAll.size() >= 2)
+    {
+        samplerUpper.Init(vector<double>(listAll.begin() + 1, listAll.end()), 2);
+    }
+}
+
+bool ECWorkloadGenerator::GetNext(int &time, int &floorSrc, int &floorDest)
+{
+    if (numGenerated >= numRequests || timeSim <= 0 || numFloors < 2)
+    {
+        return false;
+    }
+
+    // Sorted uniform samples one at a time: given the count, the arrival times of
+    // a Poisson process are sorted uniform samples of its cumulative rate, and
+    // the smallest of m uniforms above u is 1 - (1-u) V^(1/m)
+    double remaining = (double)(numRequests - numGenerated);
+    logRemain += log(1.0 - rng.NextDouble()) / remaining;
+    double share = 1.0 - exp(logRemain);
+    if (share >= listCumRate[phaseCurr] && phaseCurr + 1 < listPhases.size())
+    {
+        while (phaseCurr + 1 < listPhases.size() && share >= listCumRate[phaseCurr])
+        {
+            ++phaseCurr;
+        }
+        SetPhaseScale();
+    }
+    time = min((int)(timePhase + (share - sharePhase) * timePerShare), timeSim - 1);
+
+    GetFloors(listPhases[phaseCurr], floorSrc, floorDest);
+    ++numGenerated;
+    return true;
+}
+
+void ECWorkloadGenerator::GetFloors(const ECTrafficPhase &phase, int &floorSrc, int &floorDest)
+{
+    double kind = rng.NextDouble();
+    if (!samplerUpper.IsEmpty() && kind < phase.fracIncoming)
+    {
+        floorSrc = 1;
+        floorDest = samplerUpper.Sample(rng);
+    }
+    else if (!samplerUpper.IsEmpty() && kind < phase.fracIncoming + phase.fracOutgoing)
+    {
+        floorSrc = samplerUpper.Sample(rng);
+        floorDest = 1;
+    }
+    else
+    {
+        floorSrc = samplerAll.IsEmpty() ? 1 : samplerAll.Sample(rng);
+        floorDest = floorSrc;
+        // a few tries, then the lobby (or from it) if nearly all people are on one floor
+        for (int i = 0; i < 16 && floorDest == floorSrc && !samplerAll.IsEmpty(); ++i)
+        {
+            floorDest = samplerAll.Sample(rng);
+        }
+        if (floorDest == floorSrc)
+        {
+            floorDest = floorSrc != 1 ? 1 : 2;
+        }
+    }
+}
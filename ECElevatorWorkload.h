@@ -0,0 +1,158 @@
+//
+//  ECElevatorWorkload.h
+//
+//
+//  Reproducible synthetic workloads: Poisson arrivals over a time-of-day profile
+
+#ifndef ECElevatorWorkload_h
+#define ECElevatorWorkload_h
+
+#include "ECElevatorSim.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//*****************************************************************************
+// Small, fast random number generator (xoshiro256**, seeded through splitmix64).
+// Unlike std::rand and the std distributions, the same seed gives the same
+// numbers with every compiler and library
+
+class ECRandom
+{
+public:
+    explicit ECRandom(uint64_t seed = 1) { Seed(seed); }
+    void Seed(uint64_t seed)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            state[i] = z ^ (z >> 31);
+        }
+    }
+    uint64_t Next()
+    {
+        uint64_t result = Rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = Rotl(state[3], 45);
+        return result;
+    }
+    // in [0, 1)
+    double NextDouble() { return (Next() >> 11) * (1.0 / 9007199254740992.0); }
+    // in [0, num)
+    int NextInt(int num) { return (int)(((Next() >> 32) * (uint64_t)num) >> 32); }
+    // exponential with mean 1 / rate (e.g. the gap between Poisson arrivals)
+    double NextExponential(double rate) { return -std::log(1.0 - NextDouble()) / rate; }
+
+private:
+    static uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t state[4];
+};
+
+//*****************************************************************************
+// Floors drawn in proportion to their weights in O(1) (alias method)
+
+class ECFloorSampler
+{
+public:
+    // listWeights[i] is the weight of floor floorFirst + i; negative weights count as 0
+    void Init(const std::vector<double> &listWeights, int floorFirst);
+    bool IsEmpty() const { return listProb.empty(); }
+    int Sample(ECRandom &rng) const
+    {
+        uint64_t bits = rng.Next();
+        int i = (int)(((bits >> 32) * (uint64_t)listProb.size()) >> 32);
+        double frac = (uint32_t)bits * (1.0 / 4294967296.0);
+        return floorFirst + (frac < listProb[i] ? i : listAlias[i]);
+    }
+
+private:
+    std::vector<double> listProb;
+    std::vector<int> listAlias;
+    int floorFirst = 1;
+};
+
+//*****************************************************************************
+// A time-of-day profile is a list of phases covering the simulated day. In each
+// phase requests arrive at a constant (relative) rate, with a traffic mix:
+// incoming (from the lobby, floor 1, up to a floor), outgoing (from a floor down
+// to the lobby), and interfloor (the rest)
+
+struct ECTrafficPhase
+{
+    double timeEnd;             // fraction of the day at which the phase ends (0..1]
+    double rate;                // arrival rate relative to the other phases
+    double fracIncoming;
+    double fracOutgoing;
+};
+
+typedef enum
+{
+    EC_PROFILE_UNIFORM = 0,     // steady interfloor traffic
+    EC_PROFILE_UP_PEAK,         // morning arrivals
+    EC_PROFILE_LUNCH,           // out to lunch, then back
+    EC_PROFILE_DOWN_PEAK,       // evening departures
+    EC_PROFILE_DAY,             // a working day: up-peak, lunch and down-peak with quieter times between
+    EC_NUM_PROFILES
+} EC_WORKLOAD_PROFILE;
+
+const char *ECGetProfileName(EC_WORKLOAD_PROFILE profile);
+// false if name is not uniform, uppeak, lunch, downpeak or day
+bool ECParseProfile(const std::string &name, EC_WORKLOAD_PROFILE &profile);
+void ECGetProfilePhases(EC_WORKLOAD_PROFILE profile, std::vector<ECTrafficPhase> &listPhases);
+
+//*****************************************************************************
+// Exactly numRequests requests in [0, timeSim), in time order: a Poisson process
+// whose rate follows the profile, given the number of requests. Floors are drawn
+// by population: incoming requests go to a floor above the lobby with
+// probability proportional to its weight, outgoing ones leave from such a floor,
+// and interfloor ones go between two different floors drawn by weight (the
+// lobby's weight included). All weights are 1 unless set.
+// Requests are made one at a time with O(numFloors) memory, so the generator can
+// feed a streaming simulation or a trace of any length; the same seed always
+// gives the same requests
+
+class ECWorkloadGenerator : public ECRequestSource
+{
+public:
+    ECWorkloadGenerator(int numFloors, long long numRequests, int timeSim, EC_WORKLOAD_PROFILE profile, uint64_t seed);
+    ECWorkloadGenerator(int numFloors, long long numRequests, int timeSim, const std::vector<ECTrafficPhase> &listPhases,
+                        uint64_t seed);
+
+    // listWeights[i] is the population of floor i+1 (missing floors keep weight
+    // 1); set before the first request
+    void SetFloorWeights(const std::vector<double> &listWeights);
+
+    bool GetNext(int &time, int &floorSrc, int &floorDest) override;
+    long long GetNumGenerated() const { return numGenerated; }
+
+private:
+    void SetPhaseScale();
+    void GetFloors(const ECTrafficPhase &phase, int &floorSrc, int &floorDest);
+
+    int numFloors;
+    long long numRequests;
+    int timeSim;
+    std::vector<ECTrafficPhase> listPhases;
+    std::vector<double> listCumRate;    // share of all requests made by the end of each phase
+    ECRandom rng;
+    ECFloorSampler samplerAll;          // every floor
+    ECFloorSampler samplerUpper;        // floors above the lobby
+    long long numGenerated;
+    double logRemain;                   // log(1 - the last arrival as a share of all requests)
+    size_t phaseCurr;
+    double sharePhase;                  // share of requests made before the current phase
+    double timePhase;                   // time the current phase starts
+    double timePerShare;                // time per share of requests in the current phase
+};
+
+#endif /* ECElevatorWorkload_h */
@@ -9,6 +9,8 @@
 #include "allegro5/allegro_primitives.h"
 #include <allegro5/allegro_image.h>
 #include <allegro5/allegro_ttf.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 
@@ -36,7 +38,7 @@ ALLEGRO_COLOR arrayAllegroColors[ECGV_NUM_COLORS] =
 // A graphic view implementation
 // This is built on top of Allegro library
 
-ECGraphicViewImp :: ECGraphicViewImp(int width, int height) : widthView(width), heightView(height), fRedraw(false), display(NULL), timer(NULL), event_queue(NULL)
+ECGraphicViewImp :: ECGraphicViewImp(int width, int height) : widthView(width), heightView(height), fRedraw(false), evtCurrent(ECGV_EV_NULL), numTimerTicks(0), fTimerRunning(false), display(NULL), event_queue(NULL), timer(NULL), fontDef(NULL), bmpBackground(NULL), fBatching(false), numDrawCalls(0), numDrawCallsLastFrame(0)
 {
     Init();
 }
@@ -52,38 +54,75 @@ void ECGraphicViewImp :: Show()
     //int cursorxDown=-100, cursoryDown=-100, cursorxUp=-100, cursoryUp=-100;
     while(true)
     {
-        // get current event
-        evtCurrent = WaitForEvent();
-//std::cout << "evt: " << evtCurrent << std::endl;
-        
-        if( evtCurrent == ECGV_EV_NULL )
+        // wait for an event, then take all the others already queued: timer ticks are
+        // merged into one update, and mouse moves but the last are dropped, so after a
+        // stall the view catches up in one frame instead of replaying the backlog
+        listEvents.clear();
+        listEvents.push_back(WaitForEvent());
+        ECGVEventType evt;
+        while( GetNextEvent(evt) )
         {
-            continue;
+            listEvents.push_back(evt);
         }
-        
-        if( evtCurrent == ECGV_EV_CLOSE)
+
+        size_t iMouseLast = listEvents.size();
+        for( size_t i = 0; i < listEvents.size(); ++i )
+        {
+            if( listEvents[i] == ECGV_EV_MOUSE_MOVING )
+            {
+                iMouseLast = i;
+            }
+        }
+
+        int numTicks = 0;
+        bool fClose = false;
+        for( size_t i = 0; i < listEvents.size(); ++i )
+        {
+            evtCurrent = listEvents[i];
+//std::cout << "evt: " << evtCurrent << std::endl;
+            if( evtCurrent == ECGV_EV_NULL )
+            {
+                continue;
+            }
+            if( evtCurrent == ECGV_EV_CLOSE )
+            {
+                fClose = true;
+                break;
+            }
+            if( evtCurrent == ECGV_EV_TIMER )
+            {
+                ++numTicks;
+                continue;
+            }
+            if( evtCurrent == ECGV_EV_MOUSE_MOVING && i != iMouseLast )
+            {
+                continue;
+            }
+            
+            // Notify clients: they update their state, and ask for a redraw (SetRedraw) if it changed
+            Notify();
+        }
+        if( fClose )
         {
             break;
         }
         
-        // render start
-        RenderStart();
-        
-        // draw something
-        //DrawRectangle(100,100,200,200,3);
-	//SetRedraw(true);
-         
-        // Notify clients
-        Notify();
+        numTimerTicks = numTicks;
+        if( numTicks > 0 )
+        {
+            evtCurrent = ECGV_EV_TIMER;
+            Notify();
+        }
         
-        // refresh view
-        if( evtCurrent == ECGV_EV_TIMER)
+        // refresh view: clear, draw and flip on a timer tick (or right away while the
+        // timer is stopped), and only if asked to
+        if( fRedraw && (numTicks > 0 || fTimerRunning == false) )
         {
-            if( fRedraw )
-            {
-                RenderEnd();
-                fRedraw = false;
-            }
+            RenderStart();
+            evtCurrent = ECGV_EV_DRAW;
+            Notify();
+            RenderEnd();
+            fRedraw = false;
         }
 
 #if 0
@@ -136,6 +175,7 @@ void ECGraphicViewImp :: RenderStart()
 {
     //std::cout << "Redraw bitmap..." << GetPosX() << "," << GetPosY() << std::endl;
     al_clear_to_color(al_map_rgb(255,255,255));
+    numDrawCalls = 0;
 }
 
 
@@ -143,6 +183,7 @@ void ECGraphicViewImp :: RenderEnd()
 {
 //    al_draw_bitmap(algBitmap, GetPosX(), GetPosY(), 0);
     al_flip_display();
+    numDrawCallsLastFrame = numDrawCalls;
 }
 
     
@@ -169,6 +210,7 @@ cout << "Start init..\n";
         exit(-1);
     }
     // create the display
+    al_set_new_display_flags(ALLEGRO_RESIZABLE);
     display = al_create_display(widthView, heightView);
     if(!display) {
         cout << "failed to create display!\n";
@@ -193,6 +235,7 @@ cout << "Start init..\n";
     al_clear_to_color(al_map_rgb(255,255,255));
     al_flip_display();
     al_start_timer(timer);
+    fTimerRunning = true;
     
     // init image
     al_init_image_addon();
@@ -213,6 +256,7 @@ cout << "Done with initialization.\n";
 void ECGraphicViewImp :: Shutdown()
 {
     //
+    InvalidateBackground();
     if( display != NULL)
     {
         al_destroy_display(display);
@@ -235,6 +279,23 @@ ECGVEventType ECGraphicViewImp :: WaitForEvent()
     //
     ALLEGRO_EVENT ev;
     al_wait_for_event(event_queue, &ev);
+    return TranslateEvent(ev);
+}
+
+// Next event already in the queue; false if there is none
+bool ECGraphicViewImp :: GetNextEvent(ECGVEventType &evt)
+{
+    ALLEGRO_EVENT ev;
+    if( al_get_next_event(event_queue, &ev) == false )
+    {
+        return false;
+    }
+    evt = TranslateEvent(ev);
+    return true;
+}
+
+ECGVEventType ECGraphicViewImp :: TranslateEvent(const ALLEGRO_EVENT &ev)
+{
 //cout << "Process event...\n";
     
     if(ev.type == ALLEGRO_EVENT_DISPLAY_CLOSE)
@@ -244,6 +305,13 @@ ECGVEventType ECGraphicViewImp :: WaitForEvent()
     else if(ev.type == ALLEGRO_EVENT_TIMER) {
         return ECGV_EV_TIMER;
     }
+    else if(ev.type == ALLEGRO_EVENT_DISPLAY_RESIZE) {
+        al_acknowledge_resize(display);
+        widthView = al_get_display_width(display);
+        heightView = al_get_display_height(display);
+        InvalidateBackground();
+        return ECGV_EV_RESIZE;
+    }
     else if(ev.type == ALLEGRO_EVENT_KEY_DOWN) {
         switch(ev.keyboard.keycode) {
             case ALLEGRO_KEY_UP:
@@ -326,6 +394,44 @@ ECGVEventType ECGraphicViewImp :: WaitForEvent()
     return ECGV_EV_NULL;
 }
 
+void ECGraphicViewImp :: BeginBackground()
+{
+    if( bmpBackground == NULL )
+    {
+        bmpBackground = al_create_bitmap(widthView, heightView);
+    }
+    if( bmpBackground != NULL )
+    {
+        al_set_target_bitmap(bmpBackground);
+        al_clear_to_color(al_map_rgb(255,255,255));
+    }
+}
+
+void ECGraphicViewImp :: EndBackground()
+{
+    FlushBatch();
+    al_set_target_bitmap(al_get_backbuffer(display));
+}
+
+void ECGraphicViewImp :: DrawBackground()
+{
+    if( bmpBackground != NULL )
+    {
+        FlushBatch();
+        al_draw_bitmap(bmpBackground, 0, 0, 0);
+        ++numDrawCalls;
+    }
+}
+
+void ECGraphicViewImp :: InvalidateBackground()
+{
+    if( bmpBackground != NULL )
+    {
+        al_destroy_bitmap(bmpBackground);
+        bmpBackground = NULL;
+    }
+}
+
 void ECGraphicViewImp :: GetCursorPosition(int &cx, int &cy) const
 {
     ALLEGRO_MOUSE_STATE state;
@@ -337,50 +443,221 @@ void ECGraphicViewImp :: GetCursorPosition(int &cx, int &cy) const
 // Drawing functions
 void  ECGraphicViewImp :: DrawLine(int x1, int y1, int x2, int y2, int thickness, ECGVColor color)
 {
+    if( fBatching )
+    {
+        AddLine(x1, y1, x2, y2, thickness, color);
+        return;
+    }
     // draw a line
     al_draw_line(x1,y1,x2,y2,arrayAllegroColors[color],thickness);
+    ++numDrawCalls;
 //cout << "Draw line: (" << x1 << "," << y1 << " to (" << x2 << "," << y2 << ")\n";
 }
 
 void ECGraphicViewImp :: DrawRectangle(int x1, int y1, int x2, int y2, int thickness, ECGVColor color)
 {
+    if( fBatching )
+    {
+        AddLine(x1, y1, x2, y1, thickness, color);
+        AddLine(x2, y1, x2, y2, thickness, color);
+        AddLine(x2, y2, x1, y2, thickness, color);
+        AddLine(x1, y2, x1, y1, thickness, color);
+        return;
+    }
     al_draw_rectangle(x1, y1, x2, y2, arrayAllegroColors[color],thickness);
+    ++numDrawCalls;
 }
 
 void ECGraphicViewImp :: DrawCircle(int xcenter, int ycenter, double radius, int thickness, ECGVColor color)
 {
+    if( fBatching )
+    {
+        AddRing(xcenter, ycenter, std::max(radius - thickness / 2.0, 0.0), radius + thickness / 2.0, color);
+        return;
+    }
     al_draw_circle(xcenter, ycenter, radius, arrayAllegroColors[color], thickness);
+    ++numDrawCalls;
 }
 
 void ECGraphicViewImp :: DrawEllipse(int xcenter, int ycenter, double radiusx, double radiusy, int thickness, ECGVColor color)
 {
+    FlushBatch();
     al_draw_ellipse(xcenter, ycenter, radiusx, radiusy, arrayAllegroColors[color], thickness);
+    ++numDrawCalls;
 }
 
 void ECGraphicViewImp :: DrawFilledRectangle(int x1, int y1, int x2, int y2, ECGVColor color)
 {
-    al_draw_filled_rectangle(x1, y1, x2, y2, arrayAllegroColors[color]);;
+    if( fBatching )
+    {
+        AddQuad(x1, y1, x2, y1, x2, y2, x1, y2, color);
+        return;
+    }
+    al_draw_filled_rectangle(x1, y1, x2, y2, arrayAllegroColors[color]);
+    ++numDrawCalls;
 }
 
 void ECGraphicViewImp :: DrawFilledCircle(int xcenter, int ycenter, double radius, ECGVColor color)
 {
+    if( fBatching )
+    {
+        AddRing(xcenter, ycenter, 0, radius, color);
+        return;
+    }
     al_draw_filled_circle(xcenter, ycenter, radius, arrayAllegroColors[color]);
+    ++numDrawCalls;
 }
 
 void ECGraphicViewImp :: DrawFilledEllipse(int xcenter, int ycenter, double radiusx, double radiusy, ECGVColor color)
 {
+    FlushBatch();
     al_draw_filled_ellipse(xcenter, ycenter, radiusx, radiusy, arrayAllegroColors[color]);
+    ++numDrawCalls;
 }
 
 void ECGraphicViewImp :: DrawText(int xcenter, int ycenter, const char *ptext, ECGVColor color)
 {
+    if( fBatching )
+    {
+        listTexts.push_back({xcenter, ycenter, ptext, color});
+        return;
+    }
     al_draw_text(this->fontDef, arrayAllegroColors[color], xcenter, ycenter, ALLEGRO_ALIGN_CENTER, ptext);
+    ++numDrawCalls;
 }
 
 void ECGraphicViewImp :: DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, int thickness, ECGVColor color) {
+	if( fBatching )
+	{
+		AddLine(x1, y1, x2, y2, thickness, color);
+		AddLine(x2, y2, x3, y3, thickness, color);
+		AddLine(x3, y3, x1, y1, thickness, color);
+		return;
+	}
 	al_draw_triangle(x1, y1, x2, y2, x3, y3, arrayAllegroColors[color], thickness);
+	++numDrawCalls;
 }
 
 void ECGraphicViewImp :: DrawFilledTriangle(int x1, int y1, int x2, int y2, int x3, int y3, ECGVColor color) {
+	if( fBatching )
+	{
+		AddTriangle(x1, y1, x2, y2, x3, y3, color);
+		return;
+	}
 	al_draw_filled_triangle(x1, y1, x2, y2, x3, y3, arrayAllegroColors[color]);
-}
\ No newline at end of file
+	++numDrawCalls;
+}
+
+//***********************************************************
+// Batched drawing
+
+void ECGraphicViewImp :: BeginBatch()
+{
+    fBatching = true;
+}
+
+void ECGraphicViewImp :: EndBatch()
+{
+    FlushBatch();
+    fBatching = false;
+}
+
+void ECGraphicViewImp :: SetTimerRunning(bool f)
+{
+    if( f == fTimerRunning )
+    {
+        return;
+    }
+    if( f )
+    {
+        al_resume_timer(timer);
+    }
+    else
+    {
+        al_stop_timer(timer);
+    }
+    fTimerRunning = f;
+}
+
+void ECGraphicViewImp :: SetTitle(const std::string &title)
+{
+    al_set_window_title(display, title.c_str());
+}
+
+// Shapes in one al_draw_prim, then the text with the font's glyph bitmap held
+void ECGraphicViewImp :: FlushBatch()
+{
+    if( listVertices.empty() == false )
+    {
+        al_draw_prim(listVertices.data(), NULL, NULL, 0, (int)listVertices.size(), ALLEGRO_PRIM_TRIANGLE_LIST);
+        ++numDrawCalls;
+        listVertices.clear();
+    }
+    if( listTexts.empty() == false )
+    {
+        al_hold_bitmap_drawing(true);
+        for( const ECBatchedText &text : listTexts )
+        {
+            al_draw_text(this->fontDef, arrayAllegroColors[text.color], text.x, text.y, ALLEGRO_ALIGN_CENTER, text.text.c_str());
+        }
+        al_hold_bitmap_drawing(false);
+        ++numDrawCalls;
+        listTexts.clear();
+    }
+}
+
+void ECGraphicViewImp :: AddTriangle(float x1, float y1, float x2, float y2, float x3, float y3, ECGVColor color)
+{
+    ALLEGRO_COLOR colorAl = arrayAllegroColors[color];
+    listVertices.push_back({x1, y1, 0, 0, 0, colorAl});
+    listVertices.push_back({x2, y2, 0, 0, 0, colorAl});
+    listVertices.push_back({x3, y3, 0, 0, 0, colorAl});
+}
+
+// Corners in order around the quad
+void ECGraphicViewImp :: AddQuad(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, ECGVColor color)
+{
+    AddTriangle(x1, y1, x2, y2, x3, y3, color);
+    AddTriangle(x1, y1, x3, y3, x4, y4, color);
+}
+
+void ECGraphicViewImp :: AddLine(float x1, float y1, float x2, float y2, float thickness, ECGVColor color)
+{
+    float len = std::sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+    if( len == 0 )
+    {
+        return;
+    }
+    // half the thickness across the line (hairlines are one pixel)
+    float half = std::max(thickness, 1.0f) / 2;
+    float nx = -(y2 - y1) / len * half, ny = (x2 - x1) / len * half;
+    AddQuad(x1 + nx, y1 + ny, x2 + nx, y2 + ny, x2 - nx, y2 - ny, x1 - nx, y1 - ny, color);
+}
+
+// Disk (radiusIn = 0) or ring, with more segments for larger circles
+void ECGraphicViewImp :: AddRing(float xcenter, float ycenter, float radiusIn, float radiusOut, ECGVColor color)
+{
+    const float PI = 3.14159265f;
+    int numSegments = std::min(std::max((int)(radiusOut * 1.5f), 8), 64);
+    float xOutPrev = xcenter + radiusOut, yOutPrev = ycenter;
+    float xInPrev = xcenter + radiusIn, yInPrev = ycenter;
+    for( int i = 1; i <= numSegments; ++i )
+    {
+        float angle = 2 * PI * i / numSegments;
+        float c = std::cos(angle), s = std::sin(angle);
+        float xOut = xcenter + radiusOut * c, yOut = ycenter + radiusOut * s;
+        float xIn = xcenter + radiusIn * c, yIn = ycenter + radiusIn * s;
+        if( radiusIn <= 0 )
+        {
+            AddTriangle(xcenter, ycenter, xOutPrev, yOutPrev, xOut, yOut, color);
+        }
+        else
+        {
+            AddQuad(xInPrev, yInPrev, xOutPrev, yOutPrev, xOut, yOut, xIn, yIn, color);
+        }
+        xOutPrev = xOut;
+        yOutPrev = yOut;
+        xInPrev = xIn;
+        yInPrev = yIn;
+    }
+}
@@ -21,6 +21,8 @@
 #include "ECObserver.h"
 #include <allegro5/allegro.h>
 #include <allegro5/allegro_font.h>
+#include <allegro5/allegro_primitives.h>
+#include <string>
 
 //***********************************************************
 // Supported event codes
@@ -53,7 +55,9 @@ enum ECGVEventType
     ECGV_EV_KEY_UP_SPACE = 21,
     ECGV_EV_KEY_DOWN_SPACE = 22,
     ECGV_EV_KEY_DOWN_G = 23,
-    ECGV_EV_KEY_UP_G = 24
+    ECGV_EV_KEY_UP_G = 24,
+    ECGV_EV_RESIZE = 25,        // the window was resized (GetWidth/GetHeight are the new size)
+    ECGV_EV_DRAW = 26           // draw now: sent after a timer tick if SetRedraw(true) was called
 };
 
 //***********************************************************
@@ -115,7 +119,9 @@ public:
     // Show the view. This would enter a forever loop, until quit is set. To do things you want to do, implement code for event handling
     void Show();
     
-    // Set flag to redraw (or not). Invoke SetRedraw(true) after you make changes to the view
+    // Set flag to redraw (or not). Invoke SetRedraw(true) after you make changes to the view;
+    // on the next timer tick (or right away if the timer is stopped) the view is cleared, observers get ECGV_EV_DRAW to draw, and
+    // the frame is shown. Nothing is drawn while no one asks
     void SetRedraw(bool f) { fRedraw = f; }
     
     // Access view properties
@@ -128,6 +134,13 @@ public:
     
     // The current event
     ECGVEventType GetCurrEvent() const { return evtCurrent; }
+    // Timer ticks merged into the current ECGV_EV_TIMER (more than one when the view fell behind)
+    int GetNumTimerTicks() const { return numTimerTicks; }
+    
+    // Stop the timer while there is nothing to animate (e.g. paused), so the view waits
+    // for input without waking up; a redraw asked for meanwhile is done right away
+    void SetTimerRunning(bool f);
+    bool IsTimerRunning() const { return fTimerRunning; }
     
     // Drawing functions
     void DrawLine(int x1, int y1, int x2, int y2, int thickness=3, ECGVColor color=ECGV_BLACK);
@@ -142,6 +155,28 @@ public:
     void DrawFilledTriangle(int x1, int y1, int x2, int y2, int x3, int y3, ECGVColor color=ECGV_BLACK);
     void RenderStart();
     void RenderEnd();
+
+    // Cached background: drawing between BeginBackground and EndBackground goes to an
+    // off-screen bitmap the size of the view, which DrawBackground then copies to the
+    // view in one call. The background is dropped when the view is resized
+    bool HasBackground() const { return bmpBackground != NULL; }
+    void BeginBackground();
+    void EndBackground();
+    void DrawBackground();
+    void InvalidateBackground();
+
+    // Batched drawing: between BeginBatch and EndBatch, lines, rectangles, circles and
+    // triangles are gathered into one vertex array and drawn with a single al_draw_prim,
+    // and text is drawn after them with bitmap drawing held (so text goes on top of the
+    // shapes of the batch). Ellipses and the background flush the batch first
+    void BeginBatch();
+    void EndBatch();
+    bool IsBatching() const { return fBatching; }
+
+    // Draw calls made to Allegro for the last frame shown (a batch counts as one
+    // for its shapes and one for its text)
+    int GetNumDrawCallsLastFrame() const { return numDrawCallsLastFrame; }
+    void SetTitle(const std::string &title);
 private:
     // Internal functions
     // Initialize and reset view
@@ -153,6 +188,15 @@ private:
     
     // Process event
     ECGVEventType  WaitForEvent();
+    bool GetNextEvent(ECGVEventType &evt);
+    ECGVEventType TranslateEvent(const ALLEGRO_EVENT &ev);
+
+    // Batching
+    void FlushBatch();
+    void AddTriangle(float x1, float y1, float x2, float y2, float x3, float y3, ECGVColor color);
+    void AddQuad(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4, ECGVColor color);
+    void AddLine(float x1, float y1, float x2, float y2, float thickness, ECGVColor color);
+    void AddRing(float xcenter, float ycenter, float radiusIn, float radiusOut, ECGVColor color);
     
     // data members
     // size of view
@@ -164,12 +208,30 @@ private:
     
     // keep track of what happened to view
     ECGVEventType evtCurrent;
+    std::vector<ECGVEventType> listEvents;
+    int numTimerTicks;
+    bool fTimerRunning;
     
     // allegro stuff
     ALLEGRO_DISPLAY *display;
     ALLEGRO_EVENT_QUEUE *event_queue;
     ALLEGRO_TIMER *timer;
     ALLEGRO_FONT *fontDef;
+    ALLEGRO_BITMAP *bmpBackground;
+
+    // batched shapes and text, and draw calls of the frame being drawn
+    struct ECBatchedText
+    {
+        int x;
+        int y;
+        std::string text;
+        ECGVColor color;
+    };
+    bool fBatching;
+    std::vector<ALLEGRO_VERTEX> listVertices;
+    std::vector<ECBatchedText> listTexts;
+    int numDrawCalls;
+    int numDrawCallsLastFrame;
 };
 
 #endif /* ECGraphicViewImp_h */
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "ECElevatorBenchmark.h"
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static void PrintUsage(const char *prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --requests N,N,...   request counts (default 1000,10000,100000,1000000,10000000)\n"
+              << "  --floors N,N,...     floor counts (default 5,100,1000,10000)\n"
+              << "  --traffic T,T,...    uniform,uppeak,downpeak,interfloor (default all)\n"
+              << "  --mode M             tick, skip (next-event) or both (default tick)\n"
+              << "  --quick              request counts up to 100000 only\n"
+              << "  --seed N             workload seed (default 1)\n"
+              << "  --baseline FILE      compare ns per request with a saved baseline\n"
+              << "  --save-baseline FILE save this run as a baseline\n"
+              << "  --threshold PCT      slowdown counted as a regression (default 10)\n";
+}
+
+// Comma-separated values, each at least valueMin
+static bool ParseInts(const std::string &str, int valueMin, std::vector<int> &listValues) {
+    listValues.clear();
+    std::istringstream iss(str);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        char *end = nullptr;
+        long value = std::strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || value < valueMin || value > INT_MAX) {
+            return false;
+        }
+        listValues.push_back((int)value);
+    }
+    return !listValues.empty();
+}
+
+int main(int argc, char **argv) {
+    std::vector<int> listRequests = {1000, 10000, 100000, 1000000, 10000000};
+    std::vector<int> listFloors = {5, 100, 1000, 10000};
+    std::vector<EC_TRAFFIC> listTraffics = {EC_TRAFFIC_UNIFORM, EC_TRAFFIC_UP_PEAK, EC_TRAFFIC_DOWN_PEAK, EC_TRAFFIC_INTERFLOOR};
+    std::vector<bool> listModes = {false};
+    uint64_t seed = 1;
+    std::string fileBaseline, fileSaveBaseline;
+    double thresholdPct = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool fHasValue = i + 1 < argc;
+        if (arg == "--quick") {
+            listRequests = {1000, 10000, 100000};
+        } else if (arg == "--requests" && fHasValue) {
+            if (!ParseInts(argv[++i], 1, listRequests)) {
+                std::cerr << "Error: bad request counts: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--floors" && fHasValue) {
+            // every workload has requests going from one floor to another
+            if (!ParseInts(argv[++i], 2, listFloors)) {
+                std::cerr << "Error: bad floor counts (2 or more): " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--traffic" && fHasValue) {
+            listTraffics.clear();
+            std::istringstream iss(argv[++i]);
+            std::string name;
+            while (std::getline(iss, name, ',')) {
+                EC_TRAFFIC traffic;
+                if (!ECParseTraffic(name, traffic)) {
+                    std::cerr << "Error: unknown traffic: " << name << std::endl;
+                    return 1;
+                }
+                listTraffics.push_back(traffic);
+            }
+        } else if (arg == "--mode" && fHasValue) {
+            std::string mode = argv[++i];
+            if (mode == "tick") {
+                listModes = {false};
+            } else if (mode == "skip") {
+                listModes = {true};
+            } else if (mode == "both") {
+                listModes = {false, true};
+            } else {
+                std::cerr << "Error: unknown mode: " << mode << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seed" && fHasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--baseline" && fHasValue) {
+            fileBaseline = argv[++i];
+        } else if (arg == "--save-baseline" && fHasValue) {
+            fileSaveBaseline = argv[++i];
+        } else if (arg == "--threshold" && fHasValue) {
+            thresholdPct = std::atof(argv[++i]);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!fileBaseline.empty()) {
+        std::ifstream infile(fileBaseline);
+        if (!infile.is_open() || !ECReadBenchmarkBaseline(infile, baseline)) {
+            std::cerr << "Error: Could not read the baseline: " << fileBaseline << std::endl;
+            return 1;
+        }
+    }
+
+    // smallest runs first, so the peak memory column grows with the cases
+    std::vector<ECBenchmarkResult> listResults;
+    ECPrintBenchmarkHeader(std::cout);
+    for (int numRequests : listRequests) {
+        for (int numFloors : listFloors) {
+            for (EC_TRAFFIC traffic : listTraffics) {
+                for (bool fTimeSkipping : listModes) {
+                    ECBenchmarkCase bcase = {traffic, numFloors, numRequests, fTimeSkipping};
+                    listResults.push_back(ECRunBenchmarkCase(bcase, seed));
+                    ECPrintBenchmarkResult(std::cout, listResults.back());
+                }
+            }
+        }
+    }
+
+    std::cout << "\nScaling (time ~ requests^k):\n";
+    ECPrintBenchmarkScaling(std::cout, listResults);
+
+    int numRegressions = 0;
+    if (!fileBaseline.empty()) {
+        std::cout << "\nAgainst " << fileBaseline << ":\n";
+        numRegressions = ECPrintBenchmarkComparison(std::cout, listResults, baseline, thresholdPct);
+        std::cout << numRegressions << " regression(s) over " << thresholdPct << "%" << std::endl;
+    }
+    if (!fileSaveBaseline.empty()) {
+        std::ofstream outfile(fileSaveBaseline);
+        if (!outfile.is_open()) {
+            std::cerr << "Error: Could not write the baseline: " << fileSaveBaseline << std::endl;
+            return 1;
+        }
+        ECWriteBenchmarkBaseline(outfile, listResults);
+    }
+    return numRegressions > 0 ? 2 : 0;
+}
@@ -1,23 +1,81 @@
+#ifndef EC_NO_GUI
 #include "ECGraphicViewImp.h"
 #include "SimpleObserver.h"
+#endif
+#include "ECElevatorTrace.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
 #include <iostream>
 #include <string>
 
+static void PrintUsage(const char *prog) {
+    std::cerr << "Usage: " << prog << " [--headless] <input_file>\n"
+              << "  --headless   run at full speed with no display; print each request with its\n"
+              << "               arrival time (-1: never serviced), then the stats\n";
+}
+
+// The same run as the GUI shows, to the end, as fast as the engine goes
+static int RunHeadless(const std::string &inputFile) {
+    auto timeStart = std::chrono::steady_clock::now();
+    ECRequestFileHeader header;
+    ECElevatorRequestStore store;
+    std::string strError;
+    if (!ECLoadRequestFile(inputFile, header, store, strError)) {
+        std::cerr << "Error: Could not load the file: " << inputFile << ": " << strError << std::endl;
+        return 1;
+    }
+
+    // skipping idle time and empty floors gives the same arrival times
+    ECElevatorSim sim(header.numFloors, store);
+    sim.SetTimeSkipping(true);
+    // in chunks of the file's simulation time, never past the largest time an int
+    // holds (the car may end one time unit after the end of a chunk)
+    const int lenChunk = header.timeSim > 0 ? header.timeSim : 1;
+    while (!sim.IsFinished() && sim.GetTimeElapsed() < INT_MAX - 1) {
+        sim.Step(std::min(lenChunk, INT_MAX - 1 - sim.GetTimeElapsed()));
+    }
+    std::chrono::duration<double> timeWall = std::chrono::steady_clock::now() - timeStart;
+
+    std::ios::sync_with_stdio(false);
+    for (size_t i = 0; i < store.GetSize(); ++i) {
+        int req = (int)i;
+        std::cout << store.GetTime(req) << ' ' << store.GetFloorSrc(req) << ' ' << store.GetFloorDest(req) << ' '
+                  << (store.IsServiced(req) ? store.GetArriveTime(req) : -1) << '\n';
+    }
+    std::cout << '\n';
+    const ECElevatorSimStats &stats = sim.GetStats();
+    std::cout << "Requests: " << stats.GetNumRequests() << ", serviced: " << stats.GetNumServiced() << "\n";
+    stats.Print(std::cout);
+    std::cout << "Simulated in " << timeWall.count() << " s" << std::endl;
+    return 0;
+}
+
 int real_main(int argc, char **argv) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <input_file>" << std::endl;
+    bool fHeadless = argc == 3 && std::strcmp(argv[1], "--headless") == 0;
+    if (argc != 2 && !fHeadless) {
+        PrintUsage(argv[0]);
         return 1;
     }
-    const std::string inputFile = argv[1];
+    const std::string inputFile = argv[argc - 1];
+    if (fHeadless) {
+        return RunHeadless(inputFile);
+    }
 
+#ifndef EC_NO_GUI
     const int widthWin = 600, heightWin = 700;
     ECGraphicViewImp view(widthWin, heightWin);
     ElevatorSimulatorObserver elevatorSimulator(view, inputFile);
     view.Attach(&elevatorSimulator);
     view.Show();
     return 0;
+#else
+    std::cerr << "Error: built without the display (EC_NO_GUI); use --headless" << std::endl;
+    return 1;
+#endif
 }
 
 int main(int argc, char **argv) {
     return real_main(argc, argv);
-}
\ No newline at end of file
+}
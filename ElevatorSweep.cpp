@@ -0,0 +1,31 @@
+#include "ECElevatorSweep.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <sweep_spec> <results_csv>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream infile(argv[1]);
+    if (!infile.is_open()) {
+        std::cerr << "Error: Could not open the file: " << argv[1] << std::endl;
+        return 1;
+    }
+    ECSweepSpec spec;
+    std::string strError;
+    if (!spec.Parse(infile, strError)) {
+        std::cerr << "Error in " << argv[1] << ": " << strError << std::endl;
+        return 1;
+    }
+
+    ECElevatorSweep sweep(spec, argv[2]);
+    int numRun = sweep.Run();
+    if (numRun < 0) {
+        return 1;
+    }
+    std::cout << "Ran " << numRun << " of " << sweep.GetCells().size() << " cells; results in " << argv[2] << std::endl;
+    return 0;
+}
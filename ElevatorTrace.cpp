@@ -0,0 +1,89 @@
+#include "ECElevatorTrace.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static void PrintUsage(const char *prog) {
+    std::cerr << "Usage: " << prog << " <command> ...\n"
+              << "  convert <request_file> <trace>   request file to binary trace\n"
+              << "  text <trace> [<request_file>]    binary trace back to a request file (default standard output)\n"
+              << "  info <trace>                     header of a trace\n"
+              << "  run [--mode M] <trace>           simulate a trace with one elevator and print the stats;\n"
+              << "                                   M is skip (next-event, the default) or tick\n";
+}
+
+// Serviced requests are only counted in the stats
+class ECDiscardSink : public ECRequestSink {
+public:
+    void Put(const ECElevatorSimRequest &) override {}
+};
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    std::string command = argv[1];
+    std::string strError;
+
+    if (command == "convert" && argc == 4) {
+        std::ifstream infile(argv[2]);
+        if (!infile.is_open()) {
+            std::cerr << "Error: Could not open the file: " << argv[2] << std::endl;
+            return 1;
+        }
+        if (!ECConvertTextTrace(infile, argv[3], strError)) {
+            std::cerr << "Error: " << strError << std::endl;
+            return 1;
+        }
+    } else if (command == "text" && (argc == 3 || argc == 4)) {
+        std::ofstream outfile;
+        if (argc == 4) {
+            outfile.open(argv[3], std::ios::binary);
+            if (!outfile.is_open()) {
+                std::cerr << "Error: Could not write the file: " << argv[3] << std::endl;
+                return 1;
+            }
+        }
+        std::ios::sync_with_stdio(false);
+        if (!ECConvertBinaryTrace(argv[2], argc == 4 ? outfile : std::cout, strError)) {
+            std::cerr << "Error: " << strError << std::endl;
+            return 1;
+        }
+    } else if ((command == "info" && argc == 3) || (command == "run" && (argc == 3 || argc == 5))) {
+        // the same arrival times either way: skipping idle time is only faster
+        bool fTimeSkipping = true;
+        if (argc == 5) {
+            std::string arg = argv[2], mode = argv[3];
+            if (arg != "--mode" || (mode != "skip" && mode != "tick")) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            fTimeSkipping = mode == "skip";
+        }
+        const char *pathTrace = argv[argc - 1];
+        ECTraceFile trace;
+        if (!trace.Open(pathTrace, strError)) {
+            std::cerr << "Error: " << strError << std::endl;
+            return 1;
+        }
+        std::cout << "Version " << trace.GetHeader().version << ": " << trace.GetNumFloors() << " floors, time "
+                  << trace.GetTimeSim() << ", " << trace.GetNumRequests() << " requests" << std::endl;
+        if (command == "run") {
+            auto timeStart = std::chrono::steady_clock::now();
+            ECTraceRequestSource source(trace.begin(), trace.end());
+            ECDiscardSink sink;
+            ECElevatorSim sim(trace.GetNumFloors(), source, sink);
+            sim.SetTimeSkipping(fTimeSkipping);
+            sim.Simulate(trace.GetTimeSim());
+            std::chrono::duration<double> timeWall = std::chrono::steady_clock::now() - timeStart;
+            sim.GetStats().Print(std::cout);
+            std::cout << "Simulated in " << timeWall.count() << " s" << std::endl;
+        }
+    } else {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "ECElevatorWorkload.h"
+#include "ECElevatorTrace.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static void PrintUsage(const char *prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --floors N           floors (default 10)\n"
+              << "  --requests N         requests (default 1000)\n"
+              << "  --time T             simulated time; requests arrive in [0, T) (default 43200)\n"
+              << "  --profile P          uniform, uppeak, lunch, downpeak or day (default day)\n"
+              << "  --weights W,W,...    population of floors 1, 2, ... (missing floors: 1)\n"
+              << "  --seed N             seed (default 1)\n"
+              << "  --output FILE        request file to write (default standard output)\n"
+              << "  --binary             write a binary trace to the --output file instead\n";
+}
+
+static bool ParseWeights(const std::string &str, std::vector<double> &listWeights) {
+    listWeights.clear();
+    std::istringstream iss(str);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        char *end = nullptr;
+        double weight = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || weight < 0.0) {
+            return false;
+        }
+        listWeights.push_back(weight);
+    }
+    return !listWeights.empty();
+}
+
+int main(int argc, char **argv) {
+    int numFloors = 10;
+    long long numRequests = 1000;
+    int timeSim = 43200;
+    EC_WORKLOAD_PROFILE profile = EC_PROFILE_DAY;
+    std::vector<double> listWeights;
+    uint64_t seed = 1;
+    std::string fileOutput;
+    bool fBinary = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool fHasValue = i + 1 < argc;
+        if (arg == "--floors" && fHasValue) {
+            numFloors = std::atoi(argv[++i]);
+        } else if (arg == "--requests" && fHasValue) {
+            numRequests = std::atoll(argv[++i]);
+        } else if (arg == "--time" && fHasValue) {
+            timeSim = std::atoi(argv[++i]);
+        } else if (arg == "--profile" && fHasValue) {
+            if (!ECParseProfile(argv[++i], profile)) {
+                std::cerr << "Error: unknown profile: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--weights" && fHasValue) {
+            if (!ParseWeights(argv[++i], listWeights)) {
+                std::cerr << "Error: bad weights: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--seed" && fHasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--output" && fHasValue) {
+            fileOutput = argv[++i];
+        } else if (arg == "--binary") {
+            fBinary = true;
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (numFloors < 2 || numRequests < 0 || timeSim <= 0) {
+        std::cerr << "Error: need at least 2 floors, no negative request count and a positive time" << std::endl;
+        return 1;
+    }
+    if (fBinary && fileOutput.empty()) {
+        std::cerr << "Error: a binary trace needs an --output file" << std::endl;
+        return 1;
+    }
+
+    ECWorkloadGenerator generator(numFloors, numRequests, timeSim, profile, seed);
+    generator.SetFloorWeights(listWeights);
+    int time, floorSrc, floorDest;
+    if (fBinary) {
+        ECTraceWriter writer;
+        if (!writer.Open(fileOutput, numFloors, timeSim)) {
+            std::cerr << "Error: Could not write the file: " << fileOutput << std::endl;
+            return 1;
+        }
+        while (generator.GetNext(time, floorSrc, floorDest)) {
+            if (!writer.Write(time, floorSrc, floorDest)) {
+                std::cerr << "Error: floors of a binary trace fit in 16 bits" << std::endl;
+                return 1;
+            }
+        }
+        if (!writer.Close()) {
+            std::cerr << "Error: writing the requests failed" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    std::ofstream outfile;
+    if (!fileOutput.empty()) {
+        outfile.open(fileOutput, std::ios::binary);
+        if (!outfile.is_open()) {
+            std::cerr << "Error: Could not write the file: " << fileOutput << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &os = fileOutput.empty() ? std::cout : outfile;
+    std::ios::sync_with_stdio(false);
+
+    os << "# " << ECGetProfileName(profile) << " profile, " << numRequests << " requests, seed " << seed << "\n";
+    ECRequestFileWriter writer(os, numFloors, timeSim);
+    while (generator.GetNext(time, floorSrc, floorDest)) {
+        writer.Write(time, floorSrc, floorDest);
+    }
+    writer.Flush();
+    if (!os) {
+        std::cerr << "Error: writing the requests failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
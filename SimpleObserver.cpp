@@ -1,222 +1,240 @@
 #include "SimpleObserver.h"
+#include "ECElevatorTrace.h"
+#include <algorithm>
 #include <cmath>
-#include <cstdlib>
-#include <ctime>
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <sstream>
+
+// Simulated time units per real second; Up/Down go one step faster/slower
+static const double arraySpeeds[] = {0.25, 0.5, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+static const int EC_NUM_SPEEDS = sizeof(arraySpeeds) / sizeof(arraySpeeds[0]);
+static const int EC_SPEED_NORMAL = 2;
+// Engine steps per timer event at most: when the engine can't keep up with the
+// speed, the clock waits for it and the display keeps its frame rate
+static const int EC_MAX_STEPS_PER_FRAME = 5000;
+// Real time gaps longer than this (e.g. the window was dragged) are not caught up on
+static const double EC_MAX_FRAME_TIME = 0.25;
 
 ElevatorSimulatorObserver::ElevatorSimulatorObserver(ECGraphicViewImp &viewIn, const std::string &filename)
-    : view(viewIn), elevatorY(600 - (1 * 50)), direction(0), isMoving(false),
-      currentFloor(1), targetFloor(1), simulationTime(0), elapsedTime(0), paused(false) {
+    : view(viewIn), numFloors(10), paused(false), timeShown(0.0), timeRealLast(-1.0), indexSpeed(EC_SPEED_NORMAL),
+      timeFrom(0), floorFrom(1), timeTo(0), floorTo(1), floorShown(1.0), direction(0), isMoving(false),
+      currentFloor(1), fQueuesShownAtTo(true), fFinished(false), fDirty(true), numFloorsBackground(0),
+      numDrawCallsShown(-1) {
 
-    std::srand(std::time(nullptr)); 
     InitializeRequests(filename);
-    Draw();
+    // with no requests (e.g. the file could not be read) the run is finished at once
+    pSim.reset(new ECElevatorSim(numFloors, store));
     view.SetRedraw(true);
 }
 
 void ElevatorSimulatorObserver::InitializeRequests(const std::string &filename) {
-    std::ifstream infile(filename);
-    if (!infile.is_open()) {
-        std::cerr << "Error: Could not open the file: " << filename << std::endl;
+    ECRequestFileHeader header;
+    std::string strError;
+    if (!ECLoadRequestFile(filename, header, store, strError)) {
+        std::cerr << "Error: Could not load the file: " << filename << ": " << strError << std::endl;
         return;
     }
+    numFloors = header.numFloors;
 
-    std::string line;
-    bool isMetadataLine = true;
+    std::cout << "Passenger requests initialized" << filename << ".\n";
+}
 
-    while (std::getline(infile, line)) {
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-        if (isMetadataLine) {
-            isMetadataLine = false;
-            continue;
-        }
-        std::istringstream iss(line);
-        int time, startFloor, targetFloor;
-        if (iss >> time >> startFloor >> targetFloor) {
-            predefinedRequests.push_back({time, startFloor, targetFloor});
-        }
+void ElevatorSimulatorObserver::GetQueues(std::vector<Passenger> &listWaiting, std::vector<Passenger> &listInCabin) const {
+    const ECElevatorRequestStore &storeSim = pSim->GetRequestStore();
+    listWaiting.clear();
+    for (int req : pSim->GetPendingRequestIndices()) {
+        listWaiting.push_back({storeSim.GetFloorSrc(req), storeSim.GetFloorDest(req)});
     }
+    listInCabin.clear();
+    for (int req : pSim->GetPassengerIndicesInCabin()) {
+        listInCabin.push_back({storeSim.GetFloorSrc(req), storeSim.GetFloorDest(req)});
+    }
+}
 
-    infile.close();
+void ElevatorSimulatorObserver::AdvanceSimulation() {
+    timeFrom = timeTo;
+    floorFrom = floorTo;
 
-    std::cout << "Passenger requests initialized" << filename << ".\n";
+    // one time unit, or two when the car stops at a floor on the way
+    pSim->Step();
+    timeTo = std::max(pSim->GetTimeElapsed(), timeFrom + 1);
+    floorTo = pSim->GetCurrFloor();
 }
 
+void ElevatorSimulatorObserver::ChangeSpeed(int delta) {
+    indexSpeed = std::min(std::max(indexSpeed + delta, 0), EC_NUM_SPEEDS - 1);
+}
 
-int ElevatorSimulatorObserver::FindNearestPassengerFloor(int direction) const {
-    int nearestFloor = -1;
-    int minDistance = 10;
+void ElevatorSimulatorObserver::UpdateShownState() {
+    double floorShownPrev = floorShown;
+    int timeShownPrev = (int)timeShown;
+    int directionPrev = direction;
+
+    // fixed timestep: the engine goes one time unit at a time, as many as the clock passed
+    int numSteps = 0;
+    while (timeShown >= timeTo && !pSim->IsFinished()) {
+        if (numSteps == EC_MAX_STEPS_PER_FRAME) {
+            timeShown = timeTo;
+            break;
+        }
+        // the queues of the segment that ends now are the ones to show from here on
+        if (numSteps == 0 && !fQueuesShownAtTo) {
+            passengers.swap(passengersNext);
+            cabinPassengers.swap(cabinPassengersNext);
+            fDirty = true;
+        }
+        AdvanceSimulation();
+        ++numSteps;
+    }
 
-    for (const auto &passenger : passengers) {
-        int distance = abs(passenger.startFloor - currentFloor);
-        if ((direction == 1 && passenger.startFloor > currentFloor) || // Going up
-            (direction == -1 && passenger.startFloor < currentFloor) || // Going down
-            (direction == 0)) {
-            if (distance < minDistance) {
-                minDistance = distance;
-                nearestFloor = passenger.startFloor;
-            }
+    // the queues are only taken once the engine has caught up; after several steps
+    // the latest ones are also shown from the start of the last segment
+    if (numSteps > 0) {
+        GetQueues(passengersNext, cabinPassengersNext);
+        fQueuesShownAtTo = false;
+        if (numSteps > 1) {
+            passengers = passengersNext;
+            cabinPassengers = cabinPassengersNext;
         }
     }
 
-    return nearestFloor;
+    // the car gets to floorTo one time unit into the segment; who waits and who
+    // rides changes once it is there
+    double fracMove = std::min(std::max(timeShown - timeFrom, 0.0), 1.0);
+    if (fracMove >= 1.0 && !fQueuesShownAtTo) {
+        passengers.swap(passengersNext);
+        cabinPassengers.swap(cabinPassengersNext);
+        fQueuesShownAtTo = true;
+        fDirty = true;
+    }
+    floorShown = floorFrom + (floorTo - floorFrom) * fracMove;
+    currentFloor = (int)std::lround(floorShown);
+    isMoving = fracMove < 1.0 && floorTo != floorFrom;
+    direction = isMoving ? (floorTo > floorFrom ? 1 : -1) : 0;
+
+    // the time shown is in whole seconds
+    if (floorShown != floorShownPrev || (int)timeShown != timeShownPrev || direction != directionPrev) {
+        fDirty = true;
+    }
 }
 
 void ElevatorSimulatorObserver::Update() {
     ECGVEventType evt = view.GetCurrEvent();
 
-    // Handle pause
-    if (evt == ECGV_EV_KEY_DOWN_SPACE) {
-        paused = !paused;
+    if (evt == ECGV_EV_DRAW) {
+        Draw();
         return;
     }
 
-    // do nothing
-    if (paused) {
-        return;
-    }
-
-    if (evt == ECGV_EV_TIMER) {
-        elapsedTime += 1000 / 60;
-        if (elapsedTime >= 1000) {
-            simulationTime++;
-            elapsedTime -= 1000;
-            auto it = predefinedRequests.begin();
-            while (it != predefinedRequests.end()) {
-                if (it->time <= simulationTime) {
-                    passengers.push_back({it->startFloor, it->targetFloor});
-                    it = predefinedRequests.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-
-            if (!isMoving && !passengers.empty()) {
-                targetFloor = FindNearestPassengerFloor(0);
-                if (targetFloor != -1) {
-                    direction = (targetFloor > currentFloor) ? 1 : -1;
-                    isMoving = true;
-                }
+    // Handle pause
+    if (evt == ECGV_EV_KEY_DOWN_SPACE) {
+        paused = !paused;
+        // the clock goes on from where it stopped
+        timeRealLast = -1.0;
+        fDirty = true;
+    } else if (evt == ECGV_EV_KEY_DOWN_UP || evt == ECGV_EV_KEY_DOWN_DOWN) {
+        // Speed
+        ChangeSpeed(evt == ECGV_EV_KEY_DOWN_UP ? 1 : -1);
+        fDirty = true;
+    } else if (evt == ECGV_EV_RESIZE) {
+        fDirty = true;
+    } else if (evt == ECGV_EV_TIMER) {
+        // the clock runs on real time, not on the number of timer events
+        double timeReal = al_get_time();
+        double timeFrame = timeRealLast < 0.0 ? 0.0 : std::min(timeReal - timeRealLast, EC_MAX_FRAME_TIME);
+        timeRealLast = timeReal;
+
+        // time stands still while paused, and once everyone has arrived
+        if (!paused && !fFinished) {
+            timeShown += timeFrame * arraySpeeds[indexSpeed];
+            UpdateShownState();
+
+            // Check for simulation completion
+            if (pSim->IsFinished() && fQueuesShownAtTo && !isMoving) {
+                fFinished = true;
+                fDirty = true;
             }
         }
 
-        if (isMoving) {
-            MoveElevator();
+        // draw calls of the frame shown last, in the title
+        if (view.GetNumDrawCallsLastFrame() != numDrawCallsShown) {
+            numDrawCallsShown = view.GetNumDrawCallsLastFrame();
+            view.SetTitle("Elevator Simulator (" + std::to_string(numDrawCallsShown) + " draw calls per frame)");
         }
+    }
 
-        // Check for simulation completion
-        if (predefinedRequests.empty() && passengers.empty() && cabinPassengers.empty() && !isMoving) {
-            // Update the status text to "Simulation Completed"
-            std::string statusText = "Simulation Completed";
-            view.DrawText(300, 40, statusText.c_str(), ECGV_RED);
-            view.SetRedraw(true);
-            al_rest(1.0); // Wait for 1 seconds
-            exit(0); // Terminate the program
-        }
+    // nothing moves while paused or once finished: no timer ticks then
+    view.SetTimerRunning(!paused && !fFinished);
 
+    // a frame is drawn only when something shown changed
+    if (fDirty) {
         view.SetRedraw(true);
+        fDirty = false;
     }
-
-    Draw();
 }
 
-void ElevatorSimulatorObserver::CreateRandomPassenger() {
-    int startFloor, targetFloor;
-
-    // draw floors
-    do {
-        startFloor = std::rand() % 10 + 1;
-        targetFloor = std::rand() % 10 + 1;
-    } while (startFloor == targetFloor);
-
-    passengers.push_back({startFloor, targetFloor});
-    view.SetRedraw(true);
-
-    if (!isMoving) {
-        this->targetFloor = FindNearestPassengerFloor(1);
-        if (targetFloor != -1) {
-            direction = (targetFloor > currentFloor) ? 1 : -1;
-            isMoving = true;
-        }
-    }
+// Floors share the height of the view but 100 px at the top and at the bottom
+double ElevatorSimulatorObserver::GetFloorHeight() const {
+    return std::max(view.GetHeight() - 200, 1) / (double)numFloors;
 }
 
-void ElevatorSimulatorObserver::MoveElevator() {
-    int targetY = 600 - (targetFloor * 50);
-
-    // Move the elevator smoothly
-    if (direction == 1 && elevatorY > targetY) { // Move up
-        elevatorY -= 2;
-    } else if (direction == -1 && elevatorY < targetY) { // Head down
-        elevatorY += 2;
-    } else {
-        elevatorY = targetY;
-        StopElevator();
-    }
-    view.SetRedraw(true);
+// y of the line at the bottom of floor (fractional while the car moves)
+int ElevatorSimulatorObserver::GetFloorY(double floor) const {
+    return (int)std::lround(view.GetHeight() - 100 - (floor - 1) * GetFloorHeight());
 }
 
-void ElevatorSimulatorObserver::AddPassengerRequest(int time, int startFloor, int targetFloor) {
-    predefinedRequests.push_back({time, startFloor, targetFloor});
+// Floors labeled: all of them unless they get too thin for the text
+int ElevatorSimulatorObserver::GetLabelStep() const {
+    return std::max((int)std::ceil(20 / GetFloorHeight()), 1);
 }
 
-void ElevatorSimulatorObserver::StopElevator() {
-    currentFloor = targetFloor;
-    direction = 0;
-    isMoving = false;
-
-    // drop off passengers
-    for (auto it = cabinPassengers.begin(); it != cabinPassengers.end();) {
-        if (it->targetFloor == currentFloor) {
-            it = cabinPassengers.erase(it); // remove passenger from cabin
-        } else {
-            ++it;
-        }
-    }
+// The parts that only change with the view size or the floor count: walls,
+// floor lines, labels and empty call buttons
+void ElevatorSimulatorObserver::DrawBuilding() {
+    view.DrawFilledRectangle(0, 0, view.GetWidth(), view.GetHeight(), ECGV_YELLOW);
 
-    // pick up passengers
-    for (auto it = passengers.begin(); it != passengers.end();) {
-        if (it->startFloor == currentFloor) {
-            cabinPassengers.push_back(*it); // add to cabin
-            it = passengers.erase(it);     // remove from waiting list
-        } else {
-            ++it;
-        }
-    }
+    double scale = std::min(GetFloorHeight() / 50, 1.0);
+    int yBottom = GetFloorY(1), yTop = GetFloorY(numFloors + 1);
+
+    // Elevator limits
+    view.DrawLine(150, yTop, 150, yBottom, 3, ECGV_BLACK); // left limit
+    view.DrawLine(450, yTop, 450, yBottom, 3, ECGV_BLACK); // right limit
 
-    if (!cabinPassengers.empty()) {
-        // move to the next destination
-        targetFloor = cabinPassengers.front().targetFloor;
-        direction = (targetFloor > currentFloor) ? 1 : -1;
-        isMoving = true;
-    } else if (!passengers.empty()) {
-        int nearestFloor = FindNearestPassengerFloor(0);
-        if (nearestFloor != -1) {
-            targetFloor = nearestFloor;
-            direction = (targetFloor > currentFloor) ? 1 : -1;
-            isMoving = true;
+    for (int floor = 1; floor <= numFloors; ++floor) {
+        int i = GetFloorY(floor);
+        int circleY = GetFloorY(floor + 0.5);
+        view.DrawLine(150, i, 450, i, 2, ECGV_BLACK); // floor line
+        if ((floor - 1) % GetLabelStep() == 0) {
+            view.DrawText(120, circleY - 10, std::to_string(floor).c_str(), ECGV_BLACK);
         }
+        view.DrawCircle(470, circleY, 10 * scale, 3, ECGV_GREEN);
+        view.DrawCircle(470, circleY + (int)(20 * scale), 10 * scale, 3, ECGV_RED);
     }
-    view.SetRedraw(true);
 }
 
 void ElevatorSimulatorObserver::Draw() {
-    view.DrawFilledRectangle(0, 0, view.GetWidth(), view.GetHeight(), ECGV_YELLOW);
-    
-    // Elevator limits
-    view.DrawLine(150, 100, 150, 600, 3, ECGV_BLACK); // left limit
-    view.DrawLine(450, 100, 450, 600, 3, ECGV_BLACK); // right limit
+    // the building is drawn once and copied; it is redrawn when the view size drops
+    // it or when the number of floors changes
+    if (!view.HasBackground() || numFloorsBackground != numFloors) {
+        view.BeginBackground();
+        view.BeginBatch();
+        DrawBuilding();
+        view.EndBatch();
+        view.EndBackground();
+        numFloorsBackground = numFloors;
+    }
+    view.DrawBackground();
 
-    for (int i = 600, floor = 1; i > 100; i -= 50, ++floor) {
-        view.DrawLine(150, i, 450, i, 2, ECGV_BLACK); // floor line
-        ECGVColor textColor = (currentFloor == floor) ? ECGV_RED : ECGV_BLACK; //cabin
-        view.DrawText(120, i - 35, std::to_string(floor).c_str(), textColor);
+    // the shapes go out in one draw call and the text in another
+    view.BeginBatch();
+
+    double scale = std::min(GetFloorHeight() / 50, 1.0);
+    if ((currentFloor - 1) % GetLabelStep() == 0) {
+        view.DrawText(120, GetFloorY(currentFloor + 0.5) - 10, std::to_string(currentFloor).c_str(), ECGV_RED); //cabin
+    }
 
-        int circleY = i - 25;
+    for (int floor = 1; floor <= numFloors; ++floor) {
+        int circleY = GetFloorY(floor + 0.5);
         bool fillUp = false;
         bool fillDown = false;
 
@@ -236,23 +254,19 @@ void ElevatorSimulatorObserver::Draw() {
             }
         }
 
-        // up circle
+        // up circle (the empty ring is in the background)
         if (fillUp) {
-            view.DrawFilledCircle(470, circleY, 10, ECGV_GREEN);
-        } else {
-            view.DrawCircle(470, circleY, 10, 3, ECGV_GREEN);
+            view.DrawFilledCircle(470, circleY, 10 * scale, ECGV_GREEN);
         }
 
         // down circle
         if (fillDown) {
-            view.DrawFilledCircle(470, circleY + 20, 10, ECGV_RED);
-        } else {
-            view.DrawCircle(470, circleY + 20, 10, 3, ECGV_RED);
+            view.DrawFilledCircle(470, circleY + (int)(20 * scale), 10 * scale, ECGV_RED);
         }
 
         // Passenger Rectangle size
         int rectWidth = 50;
-        int rectHeight = 40;
+        int rectHeight = (int)(40 * scale);
 
         // Draw up passengers
         for (size_t j = 0; j < upPassengers.size(); ++j) {
@@ -265,42 +279,49 @@ void ElevatorSimulatorObserver::Draw() {
         // Draw down passengers
         for (size_t j = 0; j < downPassengers.size(); ++j) {
             int rectX = 500 + j * (rectWidth + 10);
-            int rectY = circleY + 25;
+            int rectY = circleY + (int)(25 * scale);
             view.DrawFilledRectangle(rectX, rectY, rectX + rectWidth, rectY + rectHeight, ECGV_BLUE);
             view.DrawText(rectX + 15, rectY + 10, std::to_string(downPassengers[j]).c_str(), ECGV_WHITE);
         }
     }
 
     // Draw the elevator cabin
-    view.DrawFilledRectangle(150, elevatorY, 450, elevatorY + 50, ECGV_BLUE);
+    int elevatorY = GetFloorY(floorShown + 1);
+    view.DrawFilledRectangle(150, elevatorY, 450, GetFloorY(floorShown), ECGV_BLUE);
 
     int cabinX = 200;
-    int cabinY = elevatorY + 10;
+    int cabinY = elevatorY + (int)(10 * scale);
     for (size_t i = 0; i < cabinPassengers.size(); ++i) {
         int rectX = cabinX + i * 40;
         int rectY = cabinY;
-        view.DrawFilledRectangle(rectX, rectY, rectX + 30, rectY + 20, ECGV_BLUE); 
+        view.DrawFilledRectangle(rectX, rectY, rectX + 30, rectY + (int)(20 * scale), ECGV_BLUE); 
         view.DrawText(rectX + 5, rectY + 5, std::to_string(cabinPassengers[i].targetFloor).c_str(), ECGV_WHITE); // Target floor
     }
 
     std::string passengerCountText = "Total Riders: " + std::to_string(cabinPassengers.size());
-    int bottomTextY = 650;
+    int bottomTextY = view.GetHeight() - 50;
     view.DrawText(300, bottomTextY, passengerCountText.c_str(), ECGV_BLACK);
 
-    
 
     // Textz
     //view.DrawText(300, 20, "Elevator Status:", ECGV_BLACK);
     std::string statusText;
-    if (paused) {
+    ECGVColor statusColor = ECGV_BLACK;
+    if (fFinished) {
+        // Update the status text to "Simulation Completed"
+        statusText = "Simulation Completed";
+        statusColor = ECGV_RED;
+    } else if (paused) {
         statusText = "Status: PAUSED";
     } else if (isMoving) {
         statusText = "Status: " + std::string(direction == 1 ? "Heading Up" : "Heading Down");
     } else {
         statusText = "Status: Stopped";
     }
-    view.DrawText(300, 40, statusText.c_str(), ECGV_BLACK);
+    view.DrawText(300, 40, statusText.c_str(), statusColor);
     //view.DrawText(300, 60, ("Floor: " + std::to_string(currentFloor)).c_str(), ECGV_BLACK);
-    std::string timeText = "Time: " + std::to_string(simulationTime) + "s";
-    view.DrawText(300, 10, timeText.c_str(), ECGV_BLACK);
+    std::ostringstream timeText;
+    timeText << "Time: " << (int)timeShown << "s  (x" << arraySpeeds[indexSpeed] << ")";
+    view.DrawText(300, 10, timeText.str().c_str(), ECGV_BLACK);
+    view.EndBatch();
 }
\ No newline at end of file
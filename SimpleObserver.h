@@ -3,19 +3,17 @@
 
 #include "ECObserver.h"
 #include "ECGraphicViewImp.h"
+#include "ECElevatorSim.h"
+#include <memory>
 #include <vector>
 
-struct PassengerRequest {
-    int time;
-    int startFloor;
-    int targetFloor;
-};
-
 struct Passenger {
     int startFloor;
     int targetFloor;
 };
 
+// Shows an ECElevatorSim run on a request file: the engine is stepped one time
+// unit at a time as the clock passes, and the view only draws its state
 class ElevatorSimulatorObserver : public ECObserver {
 public:
     ElevatorSimulatorObserver(ECGraphicViewImp &viewIn, const std::string &filename);
@@ -24,25 +22,50 @@ public:
 
 private:
     void Draw();                     // Helper function to draw the elevator and floors
-    void MoveElevator();             // Handle elevator movement logic
-    void StopElevator();             // Handle stopping at floors
-    void CreateRandomPassenger();    // Create a random passenger
+    void DrawBuilding();             // the static part, drawn to the cached background
+    double GetFloorHeight() const;
+    int GetFloorY(double floor) const;
+    int GetLabelStep() const;
     void InitializeRequests(const std::string &filename);
-    void AddPassengerRequest(int time, int startFloor, int targetFloor);
+    void AdvanceSimulation();        // Step the engine to the next time unit (the queues are not taken)
+    void UpdateShownState();
+    void ChangeSpeed(int delta);
+    void GetQueues(std::vector<Passenger> &listWaiting, std::vector<Passenger> &listInCabin) const;
 
     ECGraphicViewImp &view;
-    int elevatorY;                   // Elevator's current Y position
+    ECElevatorRequestStore store;    // requests of the file
+    std::unique_ptr<ECElevatorSim> pSim;
+    int numFloors;                   // from the request file header
+    bool paused;
+
+    // Simulated time shown, advanced by real time (al_get_time) times the speed
+    double timeShown;
+    double timeRealLast;             // real time of the last timer event (< 0: none yet)
+    int indexSpeed;                  // into the table of speeds (0.25x to 1000x)
+
+    // The car moves from floorFrom (at timeFrom) to floorTo in the first time unit of
+    // [timeFrom, timeTo); it stays at floorTo for the rest (stopping there)
+    int timeFrom;
+    int floorFrom;
+    int timeTo;
+    int floorTo;
+    double floorShown;               // where the car is drawn (between floors while moving)
     int direction;                   // Direction of elevator: 1 for up, -1 for down, 0 for stopped
     bool isMoving;                   // Is the elevator currently moving?
-    int currentFloor;
-    int targetFloor;
-    int simulationTime;  
-    bool paused; 
-    int elapsedTime;
-    int FindNearestPassengerFloor(int direction) const;
+    int currentFloor;                // floor the car is at or nearest to
+
+    // Queues as shown, and as they are at timeTo (shown once the car gets to floorTo)
     std::vector<Passenger> passengers;
     std::vector<Passenger> cabinPassengers;
-    std::vector<PassengerRequest> predefinedRequests;
+    std::vector<Passenger> passengersNext;
+    std::vector<Passenger> cabinPassengersNext;
+    bool fQueuesShownAtTo;
+
+    bool fFinished;                  // everyone has arrived: the clock stops
+    bool fDirty;                     // something shown changed since the last frame
+
+    int numFloorsBackground;         // floor count the cached background was drawn for
+    int numDrawCallsShown;           // in the window title
 };
 
-#endif
\ No newline at end of file
+#endif